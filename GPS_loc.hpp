@@ -12,12 +12,29 @@
 struct field;
 class item;
 class player;
+class submap;
 class vehicle;
 enum itype_id : int;
 enum ter_id : int;
 enum trap_id : int;
 enum vhtype_id : int;
 
+// writable terrain; reading through it is not a write as far as the submap's tile revision is concerned
+class ter_ref
+{
+	submap* const _sm;	// null for the out-of-bounds dummy
+	ter_id& _x;
+
+public:
+	ter_ref(submap* sm, ter_id& x) noexcept : _sm(sm), _x(x) {}
+	ter_ref(const ter_ref& src) = default;
+	~ter_ref() = default;
+	ter_ref& operator=(const ter_ref& src) { return *this = ter_id(src); }	// assigns the terrain, not the reference
+	ter_ref& operator=(ter_id src);	// submap.cpp
+
+	operator ter_id() const { return _x; }
+};
+
 constexpr int OMAP = 180;
 constexpr int OMAPX = OMAP;
 constexpr int OMAPY = OMAP;
@@ -37,7 +54,7 @@ struct GPS_loc : public std::pair<tripoint, point>
 	GPS_loc& operator+=(const tripoint& src);
 
 	// following in map.cpp
-	ter_id& ter();
+	ter_ref ter();
 	ter_id ter() const;
 	bool is_outside() const;
 	bool is_transparent() const;
@@ -54,6 +71,7 @@ struct GPS_loc : public std::pair<tripoint, point>
 	void add(const item& new_item);
 	void add(item&& new_item);
 	bool add(field&& src);
+	void replace(field&& src);	// unconditional, unlike add
 	std::optional<std::vector<GPS_loc> > sees(const GPS_loc& dest, int range) const;
 	bool can_see(const GPS_loc& dest, int range) const;
 
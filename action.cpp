@@ -233,7 +233,7 @@ static consteval bool verify_action_ident()
 
 static_assert(verify_action_ident());
 
-static action_id look_up_action(std::string ident)
+action_id look_up_action(const std::string& ident)
 {
     for (int i = 0; i < NUM_ACTIONS; i++) {
         if (action_ident(action_id(i)) == ident) return action_id(i);
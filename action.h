@@ -1,6 +1,8 @@
 #ifndef _ACTION_H_
 #define _ACTION_H_
 
+#include <string>
+
 enum action_id {
 ACTION_NULL = 0,
 // Movement
@@ -67,4 +69,6 @@ ACTION_TOGGLE_DEBUGMON,
 NUM_ACTIONS
 };
 
+action_id look_up_action(const std::string& ident);	// by its name in data/keymap.txt; ACTION_NULL if none
+
 #endif
@@ -0,0 +1,31 @@
+#include "animation.hpp"
+#include "options.h"
+#include "posix_time.h"
+
+static long speed()
+{
+#if HEADLESS
+	return 0;	// nobody to watch
+#else
+	const long ret = (long)option_table::get()[OPT_ANIMATION_SPEED];
+	return 0 < ret ? ret : 0;
+#endif
+}
+
+animation::animation(WINDOW* w, delay d) : w(w), ns(enabled() ? d / speed() : 0) {}
+
+bool animation::enabled() { return 0 < speed(); }
+
+void animation::frame() const
+{
+	if (0 >= ns) return;
+	wrefresh(w);
+	hold();
+}
+
+void animation::hold() const
+{
+	if (0 >= ns) return;
+	timespec ts = { ns / 1000000000, ns % 1000000000 };
+	nanosleep(&ts, nullptr);
+}
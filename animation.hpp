@@ -0,0 +1,38 @@
+#ifndef ANIMATION_HPP
+#define ANIMATION_HPP 1
+
+#include "wrap_curses.h"
+
+// Pacing for one map animation (an explosion, its shrapnel, a burst of fire, a creature or vehicle in flight).
+// The caller draws each frame; frame() shows it with one refresh and holds it.  OPT_ANIMATION_SPEED divides the hold;
+// at 0 there is no animation at all, and the caller should not draw (the headless simulation is always at 0).
+// A frame with nothing the player can see in it should not be shown: then nothing waits for it.
+class animation
+{
+public:
+	enum delay : long {	// nanoseconds per frame, at speed 1
+		BULLET = 10000000,
+		FLIGHT = 50000000,
+		EXPLOSION = 70000000
+	};
+
+private:
+	WINDOW* const w;
+	const long ns;
+
+public:
+	animation(WINDOW* w, delay d);
+	animation(const animation& src) = delete;
+	animation(animation&& src) = delete;
+	~animation() = default;
+	animation& operator=(const animation& src) = delete;
+	animation& operator=(animation&& src) = delete;
+
+	static bool enabled();
+	explicit operator bool() const { return 0 < ns; }
+
+	void frame() const;
+	void hold() const;	// pacing without a window to show, e.g. a vehicle move that redraws itself
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef BINARY_IO_HPP
+#define BINARY_IO_HPP 1
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// primitives for the binary save formats: LEB128 varints, zigzag for signed values, length-prefixed strings
+namespace cataclysm {
+namespace binary {
+
+inline void write_uint(std::ostream& os, unsigned long long src)
+{
+	while (0x80 <= src) {
+		os.put(char((src & 0x7F) | 0x80));
+		src >>= 7;
+	}
+	os.put(char(src));
+}
+
+inline unsigned long long read_uint(std::istream& is)
+{
+	unsigned long long ret = 0;
+	int shift = 0;
+	do {
+		const int c = is.get();
+		if (std::char_traits<char>::eof() == c) throw std::runtime_error("binary data truncated");
+		if (64 <= shift) throw std::runtime_error("binary data: varint too long");
+		ret |= (unsigned long long)(c & 0x7F) << shift;
+		if (!(c & 0x80)) return ret;
+		shift += 7;
+	} while (true);
+}
+
+inline void write_int(std::ostream& os, long long src) { write_uint(os, ((unsigned long long)src << 1) ^ (unsigned long long)(src >> 63)); }
+inline long long read_int(std::istream& is) {
+	const auto x = read_uint(is);
+	return (long long)(x >> 1) ^ -(long long)(x & 1);
+}
+
+inline void write_string(std::ostream& os, const std::string& src)
+{
+	write_uint(os, src.size());
+	os.write(src.data(), src.size());
+}
+
+inline std::string read_string(std::istream& is)
+{
+	const auto len = read_uint(is);
+	std::string ret(len, '\0');
+	if (0 < len && !is.read(&ret[0], len)) throw std::runtime_error("binary data truncated");
+	return ret;
+}
+
+}	// namespace binary
+}	// namespace cataclysm
+
+#endif
@@ -8,7 +8,7 @@
 #include "recent_msg.h"
 #include "stl_typetraits.h"
 
-static const char* JSON_transcode[] = {
+static constexpr const char* JSON_transcode[] = {
 	"batteries",
 	"metabolics",
 	"solar",
@@ -427,6 +427,7 @@ void pc::power_bionics()
 					if (bio_type.activated) {
 						if (tmp->powered) {
 							tmp->powered = false;
+							invalidate(DERIVED_BIONICS);
 							messages.add("%s powered off.", bio_type.name.c_str());
 						}
 						else if (power_level >= bio_type.power_cost || (weapon.type->id == itm_bio_claws && tmp->id == bio_claws))
@@ -475,6 +476,7 @@ void player::activate_bionic(int b)
   if (bio.powered) {
    messages.add("Your %s powers down.", bio_type.name.c_str());
    bio.powered = false;
+   invalidate(DERIVED_BIONICS);
   } else
    messages.add("You cannot power your %s", bio_type.name.c_str());
   return;
@@ -488,6 +490,7 @@ void player::activate_bionic(int b)
   if (bio_type.charge_time > 0) {
    bio.powered = true;
    bio.charge = bio_type.charge_time;
+   invalidate(DERIVED_BIONICS);
   }
   power_level -= power_cost;
  }
@@ -833,6 +836,7 @@ static void bionics_install_failure(pc* u, int success)
    int rem = rng(0, u->my_bionics.size() - 1);
    EraseAt(u->my_bionics, rem);
   }
+  u->invalidate(player::DERIVED_BIONICS);
   break;
 
  case 4:
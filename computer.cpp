@@ -14,7 +14,7 @@
 #include <stdexcept>
 
 // JSON enum transcoding
-static const char* JSON_transcode_compact[] = {
+static constexpr const char* JSON_transcode_compact[] = {
 	"OPEN",
 	"SAMPLE",
 	"RELEASE",
@@ -34,7 +34,7 @@ static const char* JSON_transcode_compact[] = {
 	"BLOOD_ANAL"
 };
 
-static const char* JSON_transcode_compfail[] = {
+static constexpr const char* JSON_transcode_compfail[] = {
 	"SHUTDOWN",
 	"ALARM",
 	"MANHACKS",
@@ -260,7 +260,7 @@ void computer::activate_function(game *g, computer_action action)
    {
    static auto gone = [&](const point& pt){
        if (const auto z = g->mon(pt)) {
-           const auto terrain = g->m.ter(pt + Direction::S);
+           const ter_id terrain = g->m.ter(pt + Direction::S);
            switch (terrain)
            {
            case t_wall_h:
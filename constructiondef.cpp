@@ -18,7 +18,7 @@ namespace construct // Construction functions.
 	// Any window tile
 	static bool able_window(const GPS_loc& loc)
 	{
-		const auto t = loc.ter();
+		const ter_id t = loc.ter();
 		return t_window_frame == t || t_window_empty == t || t_window == t;
 	}
 
@@ -31,7 +31,7 @@ namespace construct // Construction functions.
 	// Any door tile
 	static bool able_door(const GPS_loc& loc)
 	{
-		const auto t = loc.ter();
+		const ter_id t = loc.ter();
 		return t_door_c == t || t_door_b == t || t_door_o == t || t_door_locked == t;
 	}
 
@@ -41,7 +41,7 @@ namespace construct // Construction functions.
 	// Able if tile is wall
 	static bool able_wall(const GPS_loc& loc)
 	{
-		const auto t = loc.ter();
+		const ter_id t = loc.ter();
 		return t_wall_h == t || t_wall_v == t || t_wall_wood == t;
 	}
 
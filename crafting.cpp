@@ -9,17 +9,80 @@
 
 static const int CRAFTING_WIN_HEIGHT = VIEW - TABBED_HEADER_HEIGHT;
 
-inventory crafting_inventory(const player& u)  // 2020-05-28 NPC-valid
+crafting_stock::crafting_stock(const player& u)  // 2020-05-28 NPC-valid
+: crafting_stock(u.GPSpos, PICKUP_RANGE)
 {
-    inventory crafting_inv(u.GPSpos, PICKUP_RANGE);
-    crafting_inv += u.inv;
-    crafting_inv += u.weapon;
+    for (size_t i = 0; i < u.inv.size(); i++) {
+        for (const auto& it : u.inv.stack_at(i)) add(CARRIED, it);
+    }
+    if (!u.weapon.is_null()) add(CARRIED, u.weapon);
     if (u.has_bionic(bio_tools)) {
-        item tools(item::types[itm_toolset], messages.turn);
-        tools.charges = u.power_level;
-        crafting_inv += tools;
+        auto& tools = _tally[CARRIED][itm_toolset];
+        tools.amount++;
+        tools.charges += u.power_level;
+    }
+}
+
+crafting_stock::crafting_stock(const GPS_loc& origin, int range)
+{
+    for (auto& dest : _tally) dest.assign(item::types.size(), tally{ 0, 0 });
+    add_nearby(origin, range);
+}
+
+void crafting_stock::add(source src, const item& it)
+{
+    auto& dest = _tally[src];
+    const auto count = [&](const item& obj) {
+        auto& x = dest[obj.type->id];
+        x.amount++;
+        x.charges += (0 > obj.charges) ? 1 : obj.charges;
+    };
+    count(it);
+    for (const auto& within : it.contents) count(within);
+}
+
+// as inventory(const GPS_loc&, int): liquids on the ground are not usable, and fire is a tool
+void crafting_stock::add_nearby(const GPS_loc& origin, int range)
+{
+    auto& dest = _tally[NEARBY];
+    for (int x = -range; x <= range; x++) {
+        for (int y = -range; y <= range; y++) {
+            const GPS_loc src = origin + point(x, y);
+            for (const auto& obj : src.items_at()) if (!obj.made_of(LIQUID)) add(NEARBY, obj);
+            if (fd_fire == src.field_at().type) {
+                dest[itm_fire].amount++;
+                dest[itm_fire].charges++;
+            }
+        }
+    }
+}
+
+bool crafting_stock::has_tool(const component& tool) const
+{
+    return 0 >= tool.count ? has_amount(tool.type, 1) : has_charges(tool.type, tool.count);	// -1 => 1
+}
+
+bool crafting_stock::has_component(const component& comp) const
+{
+    if (item::types[comp.type]->count_by_charges() && 0 < comp.count) return has_charges(comp.type, comp.count);
+    return has_amount(comp.type, abs(comp.count));
+}
+
+bool crafting_stock::can_make(const recipe& making) const
+{
+    for (decltype(auto) min_term : making.tools) {
+        if (min_term.empty()) continue;
+        bool have = false;
+        for (decltype(auto) tool : min_term) if ((have = has_tool(tool))) break;
+        if (!have) return false;
+    }
+    for (decltype(auto) min_term : making.components) {
+        if (min_term.empty()) continue;
+        bool have = false;
+        for (decltype(auto) comp : min_term) if ((have = has_component(comp))) break;
+        if (!have) return false;
     }
-    return crafting_inv;
+    return true;
 }
 
 void game::craft()
@@ -40,7 +103,7 @@ void game::craft()
  bool done = false;
  int ch;
 
- inventory crafting_inv(crafting_inventory(u));
+ const crafting_stock crafting_inv(u);
 
  do {
   if (redraw) { // When we switch tabs, redraw the header
@@ -48,7 +111,7 @@ void game::craft()
    line = 0;
    draw_tabs(w_head, tab - 1, labels); // \todo C:Whales colors were c_ltgray, h_ltgray rather than c_white, h_white
 // Set current to all recipes in the current tab; available are possible to make
-   u.pick_recipes(current, available, tab);
+   u.pick_recipes(crafting_inv, current, available, tab);
   }
 
 // Clear the screen of recipe data, and draw it anew
@@ -78,7 +141,7 @@ void game::craft()
     mvwprintz(w_data, 3, VBAR_X, col, "Your skill level: %d", u.sklevel[current[line]->sk_primary]);
    mvwprintz(w_data, 4, VBAR_X, col, "Time to complete: %s", current[line]->time_desc().c_str());
    mvwaddstrz(w_data, 5, VBAR_X, col, "Tools required:");
-   if (current[line]->tools[0].empty()) {
+   if (current[line]->tools.empty() || current[line]->tools[0].empty()) {
     mvwputch(w_data, 6, VBAR_X, col, '>');
     mvwaddstrz(w_data, 6, VBAR_X + 2, c_green, "NONE");
     ypos = 6;
@@ -104,10 +167,7 @@ void game::craft()
 
             const itype_id type = tool.type;
             const int charges = tool.count;
-            nc_color toolcol = c_red;
-
-            if (charges <= 0 ? crafting_inv.has_amount(type, 1) : crafting_inv.has_charges(type, charges))
-                toolcol = c_green;
+            const nc_color toolcol = crafting_inv.has_tool(tool) ? c_green : c_red;
 
             std::string toolname(item::types[type]->name);
             if (0 < charges) toolname += " (" + std::to_string(charges) + " charges)";
@@ -142,13 +202,7 @@ void game::craft()
            const int count = comp.count;
            const itype_id type = comp.type;
            const itype* const i_type = item::types[type];
-           nc_color compcol = c_red;
-           if (i_type->count_by_charges() && count > 0) {
-               if (crafting_inv.has_charges(type, count))
-                   compcol = c_green;
-           }
-           else if (crafting_inv.has_amount(type, abs(count)))
-               compcol = c_green;
+           const nc_color compcol = crafting_inv.has_component(comp) ? c_green : c_red;
 
            std::string compname(std::to_string(abs(count)) + "x " + i_type->name);
            if (xpos + compname.length() >= SCREEN_WIDTH) {
@@ -211,65 +265,19 @@ void game::craft()
  refresh_all();
 }
 
-void player::pick_recipes(std::vector<const recipe*> &current,
-                        std::vector<bool> &available, craft_cat tab)
+void player::pick_recipes(const crafting_stock& crafting_inv, std::vector<const recipe*> &current,
+                        std::vector<bool> &available, craft_cat tab) const
 {
- const inventory crafting_inv(crafting_inventory(*this));
-
  current.clear();
  available.clear();
  for (const recipe* const tmp : recipe::recipes) {
 // Check if the category matches the tab, and we have the requisite skills
   if (    tmp->category == tab
       && (sk_null == tmp->sk_primary   || sklevel[tmp->sk_primary] >= tmp->difficulty)
-      && (sk_null == tmp->sk_secondary || 0 < sklevel[tmp->sk_secondary]))
-  current.push_back(tmp);
-  available.push_back(false);
- }
- for (int i = 0; i < current.size() && i < CRAFTING_WIN_HEIGHT; i++) {
-//Check if we have the requisite tools and components
-  bool have_all = true;
-
-  for(decltype(auto) min_term : current[i]->tools) {
-      bool have = false;
-      for (decltype(auto) tool : min_term) {
-          const itype_id type = tool.type;
-          const int req = tool.count;	// -1 => 1
-          if (req <= 0 ? crafting_inv.has_amount(type, 1) : crafting_inv.has_charges(type, req)) {
-              have = true;
-              break;
-          }
-      }
-      if (!have) {
-          have_all = false;
-          break;
-      }
+      && (sk_null == tmp->sk_secondary || 0 < sklevel[tmp->sk_secondary])) {
+   current.push_back(tmp);
+   available.push_back(crafting_inv.can_make(*tmp));	//Check if we have the requisite tools and components
   }
-  if (!have_all) continue;
-
-  for (decltype(auto) min_term : current[i]->components) {
-      bool have = false;
-      for (decltype(auto) comp : min_term) {
-          const itype_id type = comp.type;
-          const int count = comp.count;
-          if (item::types[type]->count_by_charges() && count > 0) {
-              if (crafting_inv.has_charges(type, count)) {
-                  have = true;
-                  break;
-              }
-          } else if (crafting_inv.has_amount(type, abs(count))) {
-              have = true;
-              break;
-          }
-      }
-      if (!have) {
-          have_all = false;
-          break;
-      }
-  }
-  if (!have_all) continue;
-
-  available[i] = true;
  }
 }
 
@@ -352,7 +360,7 @@ void consume_items(player& u, const std::vector<component>& components)
  std::vector<component> player_use;
  std::vector<component> map_use;
  std::vector<component> mixed_use;
- inventory map_inv(u.GPSpos, PICKUP_RANGE);
+ const crafting_stock map_inv(u.GPSpos, PICKUP_RANGE);
 
  for(const component& comp : components) {
   const itype_id type = comp.type;
@@ -447,7 +455,7 @@ void consume_items(player& u, const std::vector<component>& components)
 void consume_tools(player& u, const std::vector<component>& tools)
 {
  bool found_nocharge = false;
- inventory map_inv(u.GPSpos, PICKUP_RANGE);
+ const crafting_stock map_inv(u.GPSpos, PICKUP_RANGE);
  std::vector<component> player_has;
  std::vector<component> map_has;
 // Use charges of any tools that require charges used
@@ -55,8 +55,55 @@ struct recipe
  static void init();
 };
 
+class item;
 class map;
 class player;
+struct GPS_loc;
+
+// What is at hand for crafting: the player's inventory, weapon, and bio_tools, and the items within PICKUP_RANGE.
+// Tallied by item type when built, rather than copied, so each query is a lookup.  Not updated afterwards:
+// build a new one once anything has been used up or moved.
+class crafting_stock
+{
+public:
+	enum source {
+		CARRIED = 0,
+		NEARBY,
+		NUM_SOURCES
+	};
+
+	struct tally {
+		int amount;	// counts the contents of containers
+		int charges;	// an item without charges counts as one
+	};
+
+private:
+	std::vector<tally> _tally[NUM_SOURCES];	// indexed by itype_id
+
+	void add(source src, const item& it);	// both tallies are sized by the constructor
+	void add_nearby(const GPS_loc& origin, int range);
+
+public:
+	crafting_stock() = default;
+	explicit crafting_stock(const player& u);
+	crafting_stock(const GPS_loc& origin, int range);	// nearby only; for consume_items and consume_tools
+	crafting_stock(const crafting_stock& src) = default;
+	crafting_stock(crafting_stock&& src) = default;
+	~crafting_stock() = default;
+	crafting_stock& operator=(const crafting_stock& src) = default;
+	crafting_stock& operator=(crafting_stock&& src) = default;
+
+	int amount_of(itype_id it, source src) const { return (0 <= it && _tally[src].size() > it) ? _tally[src][it].amount : 0; }
+	int charges_of(itype_id it, source src) const { return (0 <= it && _tally[src].size() > it) ? _tally[src][it].charges : 0; }
+	int amount_of(itype_id it) const { return amount_of(it, CARRIED) + amount_of(it, NEARBY); }
+	int charges_of(itype_id it) const { return charges_of(it, CARRIED) + charges_of(it, NEARBY); }
+	bool has_amount(itype_id it, int quantity) const { return amount_of(it) >= quantity; }
+	bool has_charges(itype_id it, int quantity) const { return charges_of(it) >= quantity; }
+
+	bool has_tool(const component& tool) const;
+	bool has_component(const component& comp) const;
+	bool can_make(const recipe& making) const;	// tools and components; not skills
+};
 
 void consume_items(player& u, const std::vector<component>& components);	// \todo enable NPC construction
 void consume_tools(player& u, const std::vector<component>& tools);
@@ -3,6 +3,10 @@
 
 #include <string>
 #include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <stdexcept>
 
 namespace cataclysm {
 
@@ -12,6 +16,123 @@ namespace cataclysm {
 		T operator()(const char* src);	// fails unless specialized at link-time
 	};
 
+namespace enum_hash {
+
+	constexpr bool same(const char* lhs, const char* rhs)
+	{
+		while (*lhs && *lhs == *rhs) { ++lhs; ++rhs; }
+		return *lhs == *rhs;
+	}
+
+	constexpr bool is_key(const char* src) { return src && *src; }
+
+	constexpr std::uint32_t hash(const char* src, std::uint32_t seed)
+	{	// FNV-1a, seeded, with a final mix so that seeds give unrelated slots
+		std::uint32_t h = 2166136261U ^ (seed * 0x9E3779B9U);
+		while (*src) {
+			h ^= (unsigned char)(*src++);
+			h *= 16777619U;
+		}
+		h ^= h >> 15;
+		h *= 0x2C1B3C6DU;
+		h ^= h >> 12;
+		return h;
+	}
+
+	// Perfect hash (hash and displace) over a JSON_key table, built at compile time.
+	// A key hashes to a bucket; the bucket's seed rehashes it to a slot no other key uses.
+	// Null and empty table entries (placeholders such as AEA_SPLIT) are not keys.  For repeated keys the highest index wins, as the linear search it replaces.
+	template<std::size_t N>
+	class table
+	{
+	public:
+		static constexpr std::size_t buckets = N / 4 + 1;
+		static constexpr std::size_t slots = [] {
+			std::size_t ret = 1;
+			while (ret < N + N / 4 + 1) ret *= 2;
+			return ret;
+		}();
+		static_assert(N < UINT16_MAX, "enum table too large for 16-bit slots");
+
+	private:
+		std::array<std::uint32_t, buckets> _seed{};
+		std::array<std::uint16_t, slots> _slot{};	// table index + 1; 0 for empty
+
+	public:
+		constexpr table(const char* const (&keys)[N])
+		{
+			// group keys by bucket
+			std::array<std::size_t, buckets + 1> start{};
+			std::array<std::size_t, N> member{};
+			std::array<std::size_t, buckets> size{};
+			for (std::size_t i = 0; i < N; i++) if (is_key(keys[i])) start[hash(keys[i], 0) % buckets + 1]++;
+			for (std::size_t b = 0; b < buckets; b++) start[b + 1] += start[b];
+			std::size_t max_size = 0;
+			for (std::size_t i = 0; i < N; i++) {
+				if (!is_key(keys[i])) continue;
+				const std::size_t b = hash(keys[i], 0) % buckets;
+				bool repeat = false;
+				for (std::size_t k = 0; k < size[b]; k++) {
+					if (same(keys[member[start[b] + k]], keys[i])) {
+						member[start[b] + k] = i;
+						repeat = true;
+						break;
+					}
+				}
+				if (repeat) continue;
+				member[start[b] + size[b]++] = i;
+				if (max_size < size[b]) max_size = size[b];
+			}
+
+			// largest buckets first, while the slots are emptiest
+			for (std::size_t n = max_size; 0 < n; n--) {
+				for (std::size_t b = 0; b < buckets; b++) {
+					if (n != size[b]) continue;
+					std::uint32_t seed = 1;
+					while (!place(keys, &member[start[b]], n, seed)) {
+						if (UINT16_MAX < ++seed) throw std::logic_error("no perfect hash for enum table");
+					}
+					_seed[b] = seed;
+				}
+			}
+		}
+
+		// index into keys, or -1
+		constexpr std::ptrdiff_t find(const char* const (&keys)[N], const char* src) const
+		{
+			if (!src || !src[0]) return -1;
+			const std::uint16_t i = _slot[hash(src, _seed[hash(src, 0) % buckets]) % slots];
+			if (!i || !same(keys[i - 1], src)) return -1;
+			return i - 1;
+		}
+
+		// every key decodes to its own index (or that of a later repeat of it)
+		constexpr bool round_trip(const char* const (&keys)[N]) const
+		{
+			for (std::size_t i = 0; i < N; i++) {
+				if (!is_key(keys[i])) continue;
+				const auto code = find(keys, keys[i]);
+				if (0 > code || (std::size_t)code < i || !same(keys[code], keys[i])) return false;
+			}
+			return true;
+		}
+
+	private:
+		constexpr bool place(const char* const (&keys)[N], const std::size_t* member, std::size_t n, std::uint32_t seed)
+		{
+			for (std::size_t k = 0; k < n; k++) {
+				const std::size_t dest = hash(keys[member[k]], seed) % slots;
+				if (_slot[dest]) {
+					while (0 < k--) _slot[hash(keys[member[k]], seed) % slots] = 0;
+					return false;
+				}
+				_slot[dest] = std::uint16_t(member[k] + 1);
+			}
+			return true;
+		}
+	};
+
+}	// namespace enum_hash
 }
 
 #define DECLARE_JSON_ENUM_SUPPORT(TYPE)	\
@@ -48,10 +169,10 @@ const char* JSON_key(TYPE src)	\
 namespace cataclysm {	\
 	TYPE JSON_parse<TYPE>::operator()(const char* const src)	\
 	{	\
-		if (!src || !src[0]) return TYPE(0);	\
-        std::ptrdiff_t i = sizeof(STATIC_REF) / sizeof(*STATIC_REF);    \
-		while (0 < i--) if (!strcmp(STATIC_REF[i], src)) return TYPE(i + JSON_parse<TYPE>::origin);	\
-		return TYPE(0);	\
+		static constexpr const enum_hash::table<sizeof(STATIC_REF) / sizeof(*STATIC_REF)> index(STATIC_REF);	\
+		static_assert(index.round_trip(STATIC_REF), #TYPE " JSON keys do not round-trip");	\
+		const auto i = index.find(STATIC_REF, src);	\
+		return 0 <= i ? TYPE(i + JSON_parse<TYPE>::origin) : TYPE(0);	\
 	}	\
 }
 
@@ -66,10 +187,10 @@ const char* JSON_key(TYPE src)	\
 namespace cataclysm {	\
 	TYPE JSON_parse<TYPE>::operator()(const char* const src)	\
 	{	\
-		if (!src || !src[0]) return TYPE(0);	\
-        std::ptrdiff_t i = sizeof(STATIC_REF) / sizeof(*STATIC_REF);    \
-		while (0 < i--) if (!strcmp(STATIC_REF[i], src)) return TYPE(i + 1);	\
-		return TYPE(0);	\
+		static constexpr const enum_hash::table<sizeof(STATIC_REF) / sizeof(*STATIC_REF)> index(STATIC_REF);	\
+		static_assert(index.round_trip(STATIC_REF), #TYPE " JSON keys do not round-trip");	\
+		const auto i = index.find(STATIC_REF, src);	\
+		return 0 <= i ? TYPE(i + 1) : TYPE(0);	\
 	}	\
 }
 
@@ -10,7 +10,7 @@
 
 std::vector<event> event::_events;
 
-static const char* const JSON_transcode_events[] = {
+static constexpr const char* JSON_transcode_events[] = {
     "HELP",
     "WANTED",
     "ROBOT_ATTACK",
@@ -199,7 +199,7 @@ void event::actualize() const
   case EVENT_ROOTS_DIE:
    for (int x = 0; x < SEEX * MAPSIZE; x++) {
     for (int y = 0; y < SEEY * MAPSIZE; y++) {
-	 auto& t = g->m.ter(x,y);
+	 auto t = g->m.ter(x,y);
      if (t_root_wall == t && one_in(3)) t = t_underbrush;
     }
    }
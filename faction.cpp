@@ -31,7 +31,7 @@ void faction::global_toJSON(cataclysm::JSON& dest)
 }
 
 
-static const char* JSON_transcode_goals[] = {
+static constexpr const char* JSON_transcode_goals[] = {
 	"NONE",
 	"WEALTH",
 	"DOMINANCE",
@@ -45,7 +45,7 @@ static const char* JSON_transcode_goals[] = {
 	"FUNGUS"
 };
 
-static const char* const JSON_transcode_jobs[] = {
+static constexpr const char* JSON_transcode_jobs[] = {
 	"EXTORTION",
 	"INFORMATION",
 	"TRADE",
@@ -5,8 +5,9 @@
 #include "stl_limits.h"
 #include "recent_msg.h"
 #include "inline_stack.hpp"
+#include <algorithm>
 
-static const char* JSON_transcode[] = {
+static constexpr const char* JSON_transcode[] = {
 	"blood",
 	"bile",
 	"web",
@@ -52,16 +53,21 @@ static void clear_nearby_scent(GPS_loc loc)
     }
 }
 
-bool submap::process_fields()
+bool submap::_process_fields()
 {
-    if (0 >= field_count) return false;
+    std::erase_if(field_tiles, [&](const point& pt) { return fld[pt.x][pt.y].is_idle(); });
+    if (field_tiles.empty()) return false;
     bool found_field = false;
     const auto g = game::active();
-    for (int locx = 0; locx < SEEX; locx++) {
-        for (int locy = 0; locy < SEEY; locy++) {
+    // Only tiles with a field that is not idle, in the order of a full sweep.  Fields can be added anywhere as we go;
+    // as for a sweep, those ahead of us are processed this turn and those behind are not.
+    point at;
+    for (auto next = field_tiles.begin(); field_tiles.end() != next; next = std::upper_bound(field_tiles.begin(), field_tiles.end(), at, sweeps_before)) {
+        at = *next;
+            const int locx = at.x;
+            const int locy = at.y;
             field& cur = fld[locx][locy];
-            GPS_loc loc(GPS, point(locx, locy));
-            const auto pt = g->toScreen(loc);
+            GPS_loc loc(GPS, at);
 
             const field_id curtype = cur.type;
             if (curtype != fd_null) found_field = true;
@@ -206,7 +212,7 @@ bool submap::process_fields()
 
                 if (const auto veh = loc.veh_at()) veh->first->damage(veh->second, cur.density * 10, vehicle::damage_type::incendiary);
                 // Consume the terrain we're on
-                auto& terrain = loc.ter();
+                auto terrain = loc.ter();
                 if (is<explodes>(terrain)) {
                     terrain = ter_id(int(terrain) + 1);
                     cur.age = 0;
@@ -257,7 +263,7 @@ bool submap::process_fields()
                         int spread_chance = 20 * (cur.density - 1) + 10 * smoke;
                         auto& f = loc.field_at();
                         if (f.type == fd_web) spread_chance = 50 + spread_chance / 2;
-                        auto& t = loc.ter();
+                        auto t = loc.ter();
                         if (is<explodes>(t) && one_in(8 - cur.density)) {
                             exploding.push(dest);
                         } else if ((0 != pos->x || 0 != pos->y) && rng(1, 100) < spread_chance &&
@@ -302,7 +308,7 @@ bool submap::process_fields()
 
                 ub = exploding.size();
                 while (0 <= --ub) {
-                    auto& t = exploding[ub].ter();
+                    auto t = exploding[ub].ter();
                     t = ter_id(t + 1);
                     exploding[ub].explosion(40, 0, true);
                 };
@@ -558,7 +564,6 @@ retry:
                        // C:Z: discharge into other grounded tiles
                        if (1 == cur.density) {
                            cur = field();  // gone
-                           --field_count;
                            continue;
                        }
                        grounded[rng(0, ub - 1)].add(field(fd_electricity));
@@ -595,7 +600,6 @@ retry:
                        if (did_something) continue; // don't wink out completely right after doing something
                        grounded[index].add(field(fd_electricity));
                        cur = field();  // gone
-                       --field_count;
                        continue;
                    }
                    grounded[index].add(field(fd_electricity));
@@ -632,7 +636,6 @@ retry:
                        if (did_something) continue; // don't wink out completely right after doing something
                        ungrounded[index].add(field(fd_electricity));
                        cur = field();  // gone
-                       field_count--;
                        continue;
                    }
                    ungrounded[index].add(field(fd_electricity));
@@ -748,12 +751,8 @@ retry:
            cur.age = 0;
            cur.density--;
        }
-       if (0 >= cur.density) { // Totally dissipated.
-           field_count--;
-           cur = field();
-       }
+       if (0 >= cur.density) cur = field(); // Totally dissipated.
    }
-  }
  }
  return found_field;
 }
@@ -11,17 +11,21 @@
 #include "options.h"
 #include "mapbuffer.h"
 #include "mondeath.h"
-#include "posix_time.h"
 #include "file.h"
 #include "recent_msg.h"
 #include "saveload.h"
 #include "json.h"
 #include "om_cache.hpp"
+#include "savefile.hpp"
 #include "stl_limits.h"
 #include "stl_typetraits.h"
 #include "game_aux.hpp"
 #include "gui.hpp"
+#include "mob_index.hpp"
+#include "profiler.hpp"
+#include "animation.hpp"
 
+#include <chrono>
 #include <fstream>
 #include <sstream>
 #include <math.h>
@@ -109,6 +113,33 @@ game::~game()
 }
 
 void game::setup()	// early part looks like it belongs in game::game (but we return to the start screen rather than completely drop out
+{
+ reset();
+ if (opening_screen()) {// Opening menu
+// Finally, draw the screen!
+  refresh_all();
+  draw();
+ }
+}
+
+bool game::setup(const std::string& name)
+{
+ reset();
+ if (!name.empty()) {
+  try {
+   load(name);
+  } catch (const std::string& e) {
+   debuglog(e);
+   return false;
+  }
+  return true;
+ }
+ if (!u.create(this, PLTYPE_RANDOM)) return false;
+ start_game();
+ return true;
+}
+
+void game::reset()
 {
  u = pc();
  m = map(); // Init the root map with our vectors
@@ -128,6 +159,7 @@ void game::setup()	// early part looks like it belongs in game::game (but we ret
  z.clear();
  coming_to_stairs.clear();
  active_npc.clear();
+ mob_index::get().invalidate();
  factions.clear();
  active_missions.clear();
 // items_dragged.clear();
@@ -135,12 +167,6 @@ void game::setup()	// early part looks like it belongs in game::game (but we ret
  clear_scents();
 
  messages.turn.season = SUMMER;    // ... with winter conveniently a long ways off
-
- if (opening_screen()) {// Opening menu
-// Finally, draw the screen!
-  refresh_all();
-  draw();
- }
 }
 
 // range of sel2 is 0..
@@ -582,7 +608,7 @@ void game::create_starting_npcs()
 // Returns true if game is over (death, saved, quit, etc)
 bool game::do_turn()
 {
- om_cache::get().expire();  // flush unused overmaps to hard drive (not clearly correct placement)
+ om_cache::get().expire();  // evict overmaps over budget, saving those written to (not clearly correct placement)
  if (is_game_over()) {
   write_msg();
   for(decltype(auto) _mon : z) despawn(_mon, true); // Save the monsters before we die!
@@ -591,6 +617,7 @@ bool game::do_turn()
   return true;
  }
 // Actual stuff
+ std::optional<profiler::scope> world_time(std::in_place, profiler::WORLD);
  gamemode->per_turn(this);
  messages.turn.increment();
  event::process(Badge<game>());
@@ -642,7 +669,9 @@ bool game::do_turn()
   if (u.radiation > 1 && one_in(3)) u.radiation--;
   u.get_sick();
 // Auto-save on the half-hour
+  profiler::scope timing(profiler::AUTOSAVE);
   save();
+  MAPBUFFER.evict(m.loaded_submaps());	// after saving, so the regions paged out are already clean
  }
 // Update the weather, if it's time.
  if (messages.turn >= nextweather) update_weather();
@@ -655,6 +684,7 @@ bool game::do_turn()
  }
 
  process_activity();
+ world_time.reset();	// waiting on the player is not simulation time
 
  while (u.moves > 0) {
   cleanup_dead();
@@ -667,23 +697,27 @@ bool game::do_turn()
    return true;
   }
  }
- update_scent();
- m.vehmove(this);
- m.process_fields();
- m.process_active_items();
- m.step_in_field(this, u);
-
- monmove();
- update_stair_monsters();
- om_npcs_move();
- u.reset(Badge<game>());
- u.process_active_items(this);
- u.suffer(this);
-
- if (lev.z >= 0) {
-  (weather_datum::data[weather].effect)(this);
-  u.check_warmth(temperature);
+ {
+  profiler::scope turn_time(profiler::TURN);
+  { profiler::scope timing(profiler::SCENT); update_scent(); }
+  { profiler::scope timing(profiler::VEHMOVE); m.vehmove(this); }
+  { profiler::scope timing(profiler::FIELDS); m.process_fields(); }
+  { profiler::scope timing(profiler::MAP_ITEMS); m.process_active_items(); }
+  m.step_in_field(this, u);
+
+  { profiler::scope timing(profiler::MONMOVE); monmove(); }
+  { profiler::scope timing(profiler::STAIRS); update_stair_monsters(); }
+  { profiler::scope timing(profiler::OM_NPCS); om_npcs_move(); }
+  u.reset(Badge<game>());
+  { profiler::scope timing(profiler::U_ITEMS); u.process_active_items(this); }
+  { profiler::scope timing(profiler::SUFFER); u.suffer(this); }
+
+  if (lev.z >= 0) {
+   (weather_datum::data[weather].effect)(this);
+   u.check_warmth(temperature);
+  }
  }
+ profiler::get().end_turn(int(messages.turn));
 
  if (u.has_disease(DI_SLEEP) && int(messages.turn) % 300 == 0) {
   draw();
@@ -1262,37 +1296,10 @@ void game::get_input()
 
 void game::update_scent()
 {
- decltype(grscent) newscent;
- grscent[u.pos.x][u.pos.y] = !u.has_active_bionic(bio_scent_mask) ? u.scent : 0;	// bionic actively erases scent, not just suppressing yours
-
- for (int x = u.pos.x - 18; x <= u.pos.x + 18; x++) {
-  for (int y = u.pos.y - 18; y <= u.pos.y + 18; y++) {
-   newscent[x][y] = 0;
-   if (m.move_cost(x, y) != 0 || m.has_flag(bashable, x, y)) {
-    int squares_used = 0;
-    for (int i = -1; i <= 1; i++) {
-     for (int j = -1; j <= 1; j++) {
-      if (grscent[x][y] <= grscent[x+i][y+j]) {
-       newscent[x][y] += grscent[x+i][y+j];
-       squares_used++;
-      }
-     }
-    }
-    newscent[x][y] /= (squares_used + 1);
-	const auto& fd = m.field_at(x, y);
-    if (fd.type == fd_slime) clamp_lb(newscent[x][y], 10 * fd.density);
-    if (newscent[x][y] > 10000) {
-     debuglog("Wacky scent at %d, %d (%d)", x, y, newscent[x][y]);
-     newscent[x][y] = 0; // Scent should never be higher
-    }
-   }
-  }
- }
- for (int x = u.pos.x - 18; x <= u.pos.x + 18; x++) {
-  for (int y = u.pos.y - 18; y <= u.pos.y + 18; y++)
-   grscent[x][y] = newscent[x][y];
- }
- grscent[u.pos.x][u.pos.y] = (!u.has_active_bionic(bio_scent_mask) ? u.scent : 0);
+ const int here = !u.has_active_bionic(bio_scent_mask) ? u.scent : 0;	// bionic actively erases scent, not just suppressing yours
+ grscent[u.pos.x][u.pos.y] = here;
+ diffuse_scent(u.pos);
+ grscent[u.pos.x][u.pos.y] = here;
 }
 
 bool game::is_game_over()
@@ -1305,7 +1312,7 @@ bool game::is_game_over()
    //MAPBUFFER.save();
    std::ostringstream playerfile;
    playerfile << "save/" << u.name << ".sav";
-   unlink(playerfile.str().c_str());
+   savefile::get().remove(playerfile.str());
    uquit = QUIT_DIED;
    return true;
   }
@@ -1318,7 +1325,7 @@ void game::death_screen()
  gamemode->game_over(this);
  std::ostringstream playerfile;
  playerfile << "save/" << u.name << ".sav";
- unlink(playerfile.str().c_str());
+ savefile::get().remove(playerfile.str());
 
  const auto summary = u.summarize_kills();
 
@@ -1349,9 +1356,10 @@ void game::death_screen()
 
 bool game::load_master()
 {
- std::ifstream fin;
- fin.open("save/master.gsav");
- if (!fin.is_open()) return false;
+ savefile::get().drain();	// every load starts here; a previous game may still be going to disk
+ std::string contents;
+ if (!savefile::get().read("save/master.gsav", contents)) return false;
+ std::istringstream fin(std::move(contents));
  if ('{' != (fin >> std::ws).peek()) return false;
 
 	 // JSON encoded.
@@ -1369,9 +1377,9 @@ bool game::load_master()
      if (master.has_key("active_missions")) master["active_missions"].decode(active_missions);
 	 if (master.has_key("factions")) master["factions"].decode(factions);
 	 if (master.has_key("npcs")) master["npcs"].decode(active_npc);
+	 mob_index::get().invalidate();
      event::global_fromJSON(master);
 
-	 fin.close();
 	 return true;
 }
 
@@ -1380,30 +1388,57 @@ void game::load(std::string name)
  static std::string no_save("No save game exists!");
  static std::string corrupted("Save game corrupted!");
 
- load_master();	// load this first so we can validate later stages
-
- std::ifstream fin;
  std::ostringstream playerfile;
  playerfile << "save/" << name << ".sav";
- fin.open(playerfile.str().c_str());
+ std::string contents;
+ try {	// damaged containers are caught here, rather than deep inside the parsers
+	 load_master();	// load this first so we can validate later stages
+	 if (!savefile::get().read(playerfile.str(), contents)) throw no_save;
+ } catch (const std::runtime_error& e) {
+	 throw corrupted + " " + e.what();
+ }
+ std::istringstream fin(std::move(contents));
 // First, read in basic game state information.
- if (!fin.is_open()) throw no_save;
  if ('{' != (fin >> std::ws).peek()) throw corrupted;
 
  // JSON format	\todo make ACID (that is, if we error out we alter nothing)
-	JSON saved(fin);
+	// the scent map and monsters dominate the file; stream them rather than holding them as a tree
+	cataclysm::JSON_reader reader(fin);
+	JSON saved(JSON::object);
+	std::vector<int> scents;
+	bool have_scents = false;
+	std::vector<monster> monsters;
+	bool have_monsters = false;
+	bool monsters_ok = false;
+	if (!reader.begin_object()) throw corrupted;
+	while (reader.next_key()) {
+		const std::string key = reader.key();
+		if ("scents" == key) {
+			if (!reader.begin_array()) throw corrupted + " 2";
+			scents.resize(SEEX * MAPSIZE * SEEY * MAPSIZE);
+			size_t n = 0;
+			while (reader.next_element()) {
+				if (SEEX * MAPSIZE <= n) throw corrupted + " 2";
+				if (JSON::array != reader.mode() || !reader.decode(scents.data() + n * (SEEY * MAPSIZE), SEEY * MAPSIZE)) throw corrupted + " 10";
+				n++;
+			}
+			if (SEEX * MAPSIZE != n) throw corrupted + " 2";
+			have_scents = true;
+		} else if ("monsters" == key) {
+			monsters_ok = reader.decode(monsters);
+			have_monsters = true;
+		} else saved.set(key, reader.value());
+	}
+
 	int tmp;
 	tripoint com;
 	int err = 0;
 
 	if (   !saved.has_key("next") || !(++err,saved.has_key("weather")) || !(++err, saved.has_key("temperature"))
-		|| !(++err, saved.has_key("lev")) || !(++err, saved.has_key("com")) || !(++err, saved.has_key("scents"))
-		|| !(++err, saved.has_key("monsters")) || !(++err, saved.has_key("kill_counts")) || !(++err, saved.has_key("player"))
+		|| !(++err, saved.has_key("lev")) || !(++err, saved.has_key("com")) || !(++err, have_scents)
+		|| !(++err, have_monsters) || !(++err, saved.has_key("kill_counts")) || !(++err, saved.has_key("player"))
 		|| !(++err, fromJSON(saved["com"], com))) throw corrupted+" : "+std::to_string(err);
 
-	const auto& scents = saved["scents"];
-	if (cataclysm::JSON::array != scents.mode() || SEEX * MAPSIZE != scents.size()) throw corrupted + " 2";
-
 	{
 	const auto& next = saved["next"];
 		if (!next.has_key("spawn") || !next.has_key("weather")) throw corrupted + " 3";
@@ -1441,17 +1476,12 @@ void game::load(std::string name)
 
 	// return to other non-recoverable keys
 	// scent map \todo? good candidate for uuencoding
-	{
-	size_t ub = SEEX * MAPSIZE;
-	do {
-		auto& row = scents[--ub];
-		if (cataclysm::JSON::array != row.mode() || SEEY * MAPSIZE != row.size()) throw corrupted+" 10";
-		row.decode(grscent[ub], SEEY * MAPSIZE);
-	} while(0 < ub);
-	}
+	memcpy(grscent, scents.data(), sizeof(grscent));
 
 	// monsters (allows validating last_target)
-	if (!saved["monsters"].decode(z) && z.empty()) throw corrupted+" 11";
+	if (!monsters_ok && monsters.empty()) throw corrupted+" 11";
+	z = std::move(monsters);
+	mob_index::get().invalidate();
     // C:Z 0.3.1+: remove this backward-fit
     if (saved.has_key("last_target") && fromJSON(saved["last_target"], tmp)) u.set_target(tmp);
 
@@ -1462,11 +1492,11 @@ void game::load(std::string name)
 
 	// recoverable hacked-missing fields below
 	if (saved.has_key("turn") && fromJSON(saved["turn"], tmp)) messages.turn = tmp;
+	saved = JSON();
+	JSON_trim();	// loading leaves far more free JSON nodes than play will use again
     u.validate_target(validate_target);
 	// do not worry about next_npc_id/next_faction_id/next_mission_id, the master save catches these
 
- fin.close();
-
  {  // validate active_npcs (we have lev at this point so can measure who is/isn't in scope)
      const auto span = extent_deactivate();
      ptrdiff_t i = active_npc.size();
@@ -1475,7 +1505,7 @@ void game::load(std::string name)
 
          if (!submap::in_bounds(_npc.GPSpos.second)) { // defaulted i.e. from V0.2.0?
              if (map::in_bounds(_npc.pos)) { // presumably loaded from V0.2.0
-                 _npc.GPSpos = toGPS(_npc.pos);
+                 _npc.set_screenpos(toGPS(_npc.pos));
              }
          } else if (!span.contains(_npc.GPSpos.first)) {
              // off-screen!
@@ -1488,10 +1518,29 @@ void game::load(std::string name)
  draw();
 }
 
+// cost of each save, for the debug menu
+static struct {
+	struct {
+		int turn;
+		double total;	// milliseconds
+		double map;	// milliseconds
+		size_t files_queued;	// written or skipped by the save thread, after this returns
+		size_t bytes;	// handed to the save thread
+		size_t pages;
+		size_t submaps_encoded;
+		size_t submaps_reused;
+	} last;
+	size_t saves;
+	double total;	// milliseconds
+	double worst;	// milliseconds
+} saves_measured = {};
+
 void game::save()
 {
  if (gamemode->id()) return; // no-op if we're not in the main game.
 
+ const auto start = std::chrono::steady_clock::now();
+ const auto files_before = savefile::get().statistics();
  overmap::saveall();
  std::ostringstream playerfile_stem;
  playerfile_stem << "save/" << u.name;
@@ -1518,17 +1567,12 @@ void game::save()
  saved.set("player", toJSON(u));
  saved.set("turn", std::to_string(messages.turn));
 
- std::ofstream fout((playerfile_stem.str() + ".tmp").c_str());
- fout << saved;
- fout.close();
-
- unlink((playerfile_stem.str() + ".bak").c_str());
- rename((playerfile_stem.str() + ".sav").c_str(), (playerfile_stem.str() + ".bak").c_str());
- rename((playerfile_stem.str() + ".tmp").c_str(), (playerfile_stem.str() + ".sav").c_str());
+ // the save thread formats and writes these snapshots
+ savefile::get().write(playerfile_stem.str() + ".sav", playerfile_stem.str() + ".tmp", std::string(), std::move(saved), playerfile_stem.str() + ".bak");
 
 // Now write things that aren't player-specific: factions and NPCs
 
- saved.reset();
+ saved = JSON(JSON::object);
  mission::global_toJSON(tmp);
  faction::global_toJSON(tmp);
  npc::global_toJSON(tmp);
@@ -1539,25 +1583,35 @@ void game::save()
  if (!active_npc.empty()) saved.set("npcs", JSON::encode(active_npc));
  event::global_toJSON(tmp);
 
- fout.open("save/master.tmp");
- fout << saved;
- fout.close();
-
- unlink("save/master.bak");
- rename("save/master.gsav", "save/master.bak");
- rename("save/master.tmp", "save/master.gsav");
+ savefile::get().write("save/master.gsav", "save/master.tmp", std::string(), std::move(saved), "save/master.bak");
 
 // Finally, save artifacts.
  if (item::types.size() > num_all_items) {
-  fout.open("save/artifacts.gsav");
+  std::ostringstream fout;
   for (int i = num_all_items; i < item::types.size(); i++)
    fout << item::types[i]->save_data() << "\n";	// virtual function required here
-  fout.close();
+  savefile::get().write_plain("save/artifacts.gsav", fout.str());
  }
-// aaaand the overmap, and the local map.
- cur_om.save(u.name);
+// aaaand the local map (cur_om went out with overmap::saveall).
  //m.save(&cur_om, turn, levx, levy);
- MAPBUFFER.save();
+ const auto map_start = std::chrono::steady_clock::now();
+ MAPBUFFER.save(m.loaded_submaps());
+
+ const auto end = std::chrono::steady_clock::now();
+ const auto files_after = savefile::get().statistics();
+ const auto& pages = MAPBUFFER.last_save();
+ auto& stats = saves_measured;
+ stats.last.turn = messages.turn;
+ stats.last.total = std::chrono::duration<double, std::milli>(end - start).count();
+ stats.last.map = std::chrono::duration<double, std::milli>(end - map_start).count();
+ stats.last.files_queued = files_after.queued - files_before.queued;
+ stats.last.bytes = pages.bytes;
+ stats.last.pages = pages.pages;
+ stats.last.submaps_encoded = pages.encoded;
+ stats.last.submaps_reused = pages.reused;
+ stats.saves++;
+ stats.total += stats.last.total;
+ if (stats.worst < stats.last.total) stats.worst = stats.last.total;
 }
 
 void game::debug()
@@ -1577,7 +1631,16 @@ void game::debug()
                    "Learn all melee styles", // 12
                    "Check NPC",              // 13
                    "Spawn Artifact",         // 14
-                   "Cancel"});               // 15
+                   "Benchmark pathfinding",  // 15
+                   "Check monster index",    // 16
+                   "Benchmark submap lookup", // 17
+                   "Check submap save formats", // 18
+                   "Overmap cache statistics", // 19
+                   "Benchmark JSON loading", // 20
+                   "Autosave statistics",    // 21
+                   "Cross-check cached player stats",	// 22
+                   "Turn-time profile",      // 23
+                   "Cancel"});               // 24
  std::vector<std::string> opts;
  switch (action) {
   case 1:
@@ -1639,6 +1702,8 @@ z.size(), event::are_queued());
    if (!active_npc.empty())
     popup_top("%s: %d:%d (you: %d:%d)", active_npc[0]->name.c_str(),
               active_npc[0]->pos.x, active_npc[0]->pos.y, u.pos.x, u.pos.y);
+   popup_top("Field of view: %llu frames, %llu memo hits, %llu line searches (%.3f ms)",
+             map::fov_stats.scopes, map::fov_stats.hits, map::fov_stats.misses, map::fov_stats.nanoseconds / 1e6);
    break;
 
   case 8:
@@ -1716,6 +1781,154 @@ z.size(), event::are_queued());
        m.add_item(*center, new_natural_artifact(prop), 0);
    }
    break;
+
+  case 15: {
+   // worst case for map::route: opposite corners of the reality bubble, both directions
+   static constexpr const int trials = 100;
+   const point corner(SEE * MAPSIZE - 1);
+   size_t path_len = 0;
+   const auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < trials; i++) {
+    path_len += m.route(point(0), corner).size();
+    path_len += m.route(corner, point(0)).size();
+   }
+   const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+   popup("%d routes: %.1f microseconds/route, mean path length %.1f", 2 * trials, elapsed.count() / (2 * trials), double(path_len) / (2 * trials));
+  } break;
+
+  case 16: {
+   auto& index = indexed_mobs();
+   if (const size_t errors = index.check(z, active_npc)) popup("Monster/NPC index: %d disagreements with linear scan (%d entries)", (int)errors, (int)index.size());
+   else popup("Monster/NPC index agrees with linear scan (%d entries)", (int)index.size());
+  } break;
+
+  case 17: {
+   // scattered hits across everything resident, then the same number of misses one z-level up
+   const auto resident = MAPBUFFER.sorted();
+   if (resident.empty()) break;
+   static constexpr const int trials = 100000;
+   std::vector<tripoint> keys;
+   keys.reserve(trials);
+   for (int i = 0; i < trials; i++) keys.push_back(resident[rng(0, resident.size() - 1)].first);
+   size_t found = 0;
+   auto start = std::chrono::steady_clock::now();
+   for (const auto& pt : keys) if (MAPBUFFER.lookup_submap(pt)) found++;
+   const std::chrono::duration<double, std::nano> hit_time = std::chrono::steady_clock::now() - start;
+   start = std::chrono::steady_clock::now();
+   for (const auto& pt : keys) if (MAPBUFFER.lookup_submap(pt + tripoint(0, 0, 1))) found++;
+   const std::chrono::duration<double, std::nano> miss_time = std::chrono::steady_clock::now() - start;
+   popup("%d submaps resident: %.1f ns/hit, %.1f ns/miss (%d found)", (int)resident.size(), hit_time.count() / trials, miss_time.count() / trials, (int)found);
+  } break;
+  case 18: {
+   // every resident submap through both the text and binary formats
+   size_t failed = 0;
+   size_t text_bytes = 0;
+   size_t binary_bytes = 0;
+   const auto resident = MAPBUFFER.sorted();
+   for (const auto& x : resident) {
+    size_t text_len, binary_len;
+    if (!x.second->check_round_trip(text_len, binary_len)) {
+     if (!failed) debuglog("submap (%d,%d,%d) does not round-trip", x.first.x, x.first.y, x.first.z);
+     failed++;
+    }
+    text_bytes += text_len;
+    binary_bytes += binary_len;
+   }
+   popup("%d of %d submaps failed to round-trip; %d bytes as text, %d as binary", (int)failed, (int)resident.size(), (int)text_bytes, (int)binary_bytes);
+  } break;
+  case 19: {
+   const auto stats = om_cache::get().statistics();
+   popup("%d overmaps cached, %d KiB of %d KiB\n%d hits, %d misses, %d hard drive probes\n%d evictions, %d of them saved first",
+         (int)stats.resident, (int)(stats.bytes >> 10), (int)(stats.budget >> 10), (int)stats.hits, (int)stats.misses, (int)stats.probes,
+         (int)stats.evictions, (int)stats.write_backs);
+  } break;
+  case 20: {
+   // submap-like terrain grids, as a tree and then as a stream
+   static constexpr const int grids = 4000;
+   std::string doc;
+   {
+   std::ostringstream os;
+   os << "[";
+   for (int n = 0; n < grids; n++) {
+    os << (n ? "," : "") << "{\"turn\":" << n << ",\"terrain\":[";
+    for (int j = 0; j < SEEY; j++) {
+     os << (j ? "," : "") << "[";
+     for (int i = 0; i < SEEX; i++) os << (i ? "," : "") << "\"" << JSON_key(ter_id(rng(t_dirt, t_tree))) << "\"";
+     os << "]";
+    }
+    os << "]}";
+   }
+   os << "]";
+   doc = os.str();
+   }
+   size_t tree_cells = 0;
+   auto start = std::chrono::steady_clock::now();
+   {
+   std::istringstream is(doc);
+   JSON tree(is);
+   for (size_t n = 0; n < tree.size(); n++) {
+    const auto& grid = tree[n]["terrain"];
+    for (size_t j = 0; j < grid.size(); j++) tree_cells += grid[j].size();
+   }
+   }
+   const std::chrono::duration<double, std::milli> tree_time = std::chrono::steady_clock::now() - start;
+   size_t stream_cells = 0;
+   start = std::chrono::steady_clock::now();
+   {
+   std::istringstream is(doc);
+   cataclysm::JSON_reader reader(is);
+   reader.begin_array();
+   while (reader.next_element()) {
+    reader.begin_object();
+    while (reader.next_key()) {
+     if ("terrain" != reader.key() || !reader.begin_array()) {
+      reader.skip();
+      continue;
+     }
+     while (reader.next_element()) {
+      reader.begin_array();
+      while (reader.next_element()) if (reader.scalar()) stream_cells++;
+     }
+    }
+   }
+   }
+   const std::chrono::duration<double, std::milli> stream_time = std::chrono::steady_clock::now() - start;
+   popup("%d KiB of JSON, %d cells\ntree: %.1f ms\nstream: %.1f ms (%d cells)", (int)(doc.size() >> 10), (int)tree_cells,
+         tree_time.count(), stream_time.count(), (int)stream_cells);
+  } break;
+  case 21: {
+   if (!saves_measured.saves) {
+    popup("No saves yet this session.");
+    break;
+   }
+   const auto& last = saves_measured.last;
+   const auto files = savefile::get().statistics();
+   popup("Last save, turn %d: %.1f ms (map %.1f ms)\n%d files queued, %d of them map pages\n%d submaps encoded, %d reused; %d KiB of pages\n%d saves: %.1f ms mean, %.1f ms worst\nSave thread: %d files written, %d unchanged, %d KiB\n%.1f ms writing; %d stalls on a full queue",
+         last.turn, last.total, last.map, (int)last.files_queued, (int)last.pages,
+         (int)last.submaps_encoded, (int)last.submaps_reused, (int)(last.bytes >> 10),
+         (int)saves_measured.saves, saves_measured.total / saves_measured.saves, saves_measured.worst,
+         (int)files.written, (int)files.unchanged, (int)(files.bytes >> 10), files.write_ms, (int)files.stalls);
+  } break;
+  case 22:
+   player::cross_check = !player::cross_check;
+   popup("Cached player stats are %s checked against recomputation.\n%d mismatches so far (details in the log).",
+         player::cross_check ? "now" : "no longer", (int)player::cross_check_failures);
+   break;
+  case 23: {
+   auto& prof = profiler::get();
+   full_screen_popup("%s", prof.report().c_str());
+   if (prof.enabled) {
+    if (query_yn("Write save/profile.csv?")) {
+     if (prof.write_csv("save/profile.csv")) popup("Profile written to save/profile.csv.");
+     else popup("Could not write save/profile.csv.");
+    }
+    if (query_yn("Stop recording?")) prof.enabled = false;
+    else if (query_yn("Clear the profile?")) prof.reset();
+   } else if (query_yn("Start recording turn times?")) {
+    prof.reset();
+    prof.enabled = true;
+   }
+  } break;
  }
  erase();
  refresh_all();
@@ -1970,6 +2183,7 @@ void game::draw()
  static const char* const season_name[4] = { "Spring", "Summer", "Autumn", "Winter" };
 
  // Draw map
+ const map::fov_scope frame(m, u.pos);  // nothing below changes what the player can see
  werase(w_terrain);
  draw_ter();
  u.draw_footsteps(w_terrain);
@@ -2022,6 +2236,7 @@ void game::draw()
 
 void game::draw_ter(const point& pos)
 {
+ const map::fov_scope frame(m, u.pos);
  m.draw(w_terrain, u, pos);
 
  // Draw monsters
@@ -2492,6 +2707,7 @@ void game::z_erase(std::function<bool(monster&)> reject)
     while (0 < --i) {
         if (reject(z[i])) {
             EraseAt(z, i);
+            mob_index::get().invalidate();
             u.target_dead(i);
         }
     }
@@ -2507,7 +2723,10 @@ void game::cleanup_dead()
 
  ptrdiff_t i = active_npc.size();
  while(0 < i--) {
-   if (active_npc[i]->dead) EraseAt(active_npc, i);
+   if (active_npc[i]->dead) {
+       EraseAt(active_npc, i);
+       mob_index::get().invalidate();
+   }
  }
 }
 
@@ -2774,11 +2993,61 @@ struct hit_by_shrapnel
     }
 };
 
+// A ring per frame out to radius; only what the player can see is drawn.
+static void animate_blast(game& g, const GPS_loc& epicenter, int radius)
+{
+    const animation anim(g.w_terrain, animation::EXPLOSION);
+    if (!anim) return;
+    const auto full_center = epicenter - g.u.GPSpos;
+    const auto center = std::get_if<point>(&full_center);
+    if (!center) return; // \todo build out multi-level display
+    const point origin = *center + point(VIEW_CENTER);
+    for (int i = 1; i <= radius; i++) {
+        bool shown = false;
+        auto draw = [&](const point& delta, char sym) {
+            if (!g.u.see(epicenter + delta)) return;
+            mvwputch(g.w_terrain, origin.y + delta.y, origin.x + delta.x, c_red, sym);
+            shown = true;
+        };
+        draw(point(-i, -i), '/');
+        draw(point(i, -i), '\\');
+        draw(point(-i, i), '\\');
+        draw(point(i, i), '/');
+        for (int j = 1 - i; j < 0 + i; j++) {
+            draw(point(j, -i), '-');
+            draw(point(j, i), '-');
+            draw(point(-i, j), '|');
+            draw(point(i, j), '|');
+        }
+        if (shown) anim.frame();
+    }
+}
+
+// All the shrapnel flies at once: frame i moves each piece the player can see to step i of its flight.
+static void animate_shrapnel(game& g, const std::vector<std::vector<GPS_loc> >& flights)
+{
+    const animation anim(g.w_terrain, animation::BULLET);
+    if (!anim) return;
+    size_t steps = 0;
+    for (decltype(auto) flight : flights) clamp_lb(steps, flight.size());
+    for (size_t i = 0; i < steps; i++) {
+        bool shown = false;
+        for (decltype(auto) flight : flights) {
+            if (flight.size() <= i) continue;
+            if (0 < i && g.u.see(flight[i - 1])) g.m.drawsq(g.w_terrain, g.u, flight[i - 1], false, true);
+            if (!g.u.see(flight[i])) continue;
+            const point draw_at = std::get<point>(flight[i] - g.u.GPSpos) + point(VIEW_CENTER);
+            mvwputch(g.w_terrain, draw_at.y, draw_at.x, c_red, '`');
+            shown = true;
+        }
+        if (shown) anim.frame();
+    }
+}
+
 void game::explosion(const point& pt, int power, int shrapnel, bool fire)
 {
  if (0 >= power) return; // no-op if zero power (could happen if vehicle gas tank near-empty
 
- timespec ts = { 0, EXPLOSION_SPEED };	// Timespec for the animation of the explosion
  int radius = sqrt(double(power / 4));
  int dam;
  if (power >= 30)
@@ -2798,55 +3067,38 @@ void game::explosion(const point& pt, int power, int shrapnel, bool fire)
    if (auto _mob = mob_at(point(i, j))) std::visit(hit_by_explosion(dam, point(i,j)), *_mob);
 
    if (fire) {
-	auto& f = m.field_at(i, j);
-    if (f.type == fd_smoke) f = field(fd_fire);
+    if (fd_smoke == m.field_at(i, j).type) m.replace_field(field(fd_fire), i, j);
     m.add_field(this, i, j, fd_fire, dam / 10);
    }
   }
  }
 // Draw the explosion
- const point epicenter(pt + point(VIEW_CENTER) - u.pos);
- for (int i = 1; i <= radius; i++) {
-  mvwputch(w_terrain, epicenter.y - i, epicenter.x - i, c_red, '/');
-  mvwputch(w_terrain, epicenter.y - i, epicenter.x + i, c_red,'\\');
-  mvwputch(w_terrain, epicenter.y + i, epicenter.x - i, c_red,'\\');
-  mvwputch(w_terrain, epicenter.y + i, epicenter.x + i, c_red, '/');
-  for (int j = 1 - i; j < 0 + i; j++) {
-   mvwputch(w_terrain, epicenter.y - i, epicenter.x + j, c_red,'-');
-   mvwputch(w_terrain, epicenter.y + i, epicenter.x + j, c_red,'-');
-   mvwputch(w_terrain, epicenter.y + j, epicenter.x - i, c_red,'|');
-   mvwputch(w_terrain, epicenter.y + j, epicenter.x + i, c_red,'|');
-  }
-  wrefresh(w_terrain);
-  nanosleep(&ts, nullptr);
- }
+ const GPS_loc epicenter(toGPS(pt));
+ animate_blast(*this, epicenter, radius);
 
 // The rest of the function is shrapnel
  if (shrapnel <= 0) return;
  int sx, sy;
  std::vector<point> traj;
- ts.tv_sec = 0;
- ts.tv_nsec = BULLET_SPEED;	// Reset for animation of bullets
+ std::vector<std::vector<GPS_loc> > flights;
+ const bool animating = animation::enabled();
  for (int i = 0; i < shrapnel; i++) {
   sx = rng(pt.x - 2 * radius, pt.x + 2 * radius);
   sy = rng(pt.y - 2 * radius, pt.y + 2 * radius);
   traj = line_to(pt.x, pt.y, sx, sy, m.sees(pt, sx, sy, 50));
   dam = rng(20, 60);
+  if (animating) {
+   auto& flight = flights.emplace_back();
+   for (const point& at : traj) flight.push_back(toGPS(at));
+  }
   for (int j = 0; j < traj.size(); j++) {
-   if (j > 0 && u.see(traj[j - 1]))
-    m.drawsq(w_terrain, u, traj[j - 1].x, traj[j - 1].y, false, true);
-   if (u.see(traj[j])) {
-    const point draw_at(traj[j] + point(VIEW_CENTER) - u.pos);
-    mvwputch(w_terrain, draw_at.y, draw_at.x, c_red, '`');
-    wrefresh(w_terrain);
-    nanosleep(&ts, nullptr);
-   }
    if (auto mob = mob_at(traj[j])) {
     std::visit(hit_by_shrapnel(dam), *mob);
    } else
     m.shoot(this, traj[j], dam, j == traj.size() - 1, 0);
   }
  }
+ animate_shrapnel(*this, flights);
 }
 
 void GPS_loc::explosion(int power, int shrapnel, bool fire) const
@@ -2871,60 +3123,35 @@ void GPS_loc::explosion(int power, int shrapnel, bool fire) const
         if (auto _mob = game::active()->mob_at(loc)) std::visit(hit_by_explosion(dam, loc), *_mob);
 
         if (fire) {
-            auto& f = loc.field_at();
-            if (fd_smoke == f.type) f = field(fd_fire);
+            if (fd_smoke == loc.field_at().type) loc.replace(field(fd_fire));
             loc.add(field(fd_fire, dam / 10));
         }
     });
 
     // Draw the explosion
-    auto full_epicenter = *this - g->u.GPSpos;
-    if (std::get_if<tripoint>(&full_epicenter)) return; // \todo build out multi-level display
-    auto epicenter = std::get<point>(full_epicenter) + point(VIEW_CENTER);
-    timespec ts = { 0, EXPLOSION_SPEED };	// Timespec for the animation of the explosion
-    for (int i = 1; i <= radius; i++) {
-        mvwputch(g->w_terrain, epicenter.y - i, epicenter.x - i, c_red, '/');
-        mvwputch(g->w_terrain, epicenter.y - i, epicenter.x + i, c_red, '\\');
-        mvwputch(g->w_terrain, epicenter.y + i, epicenter.x - i, c_red, '\\');
-        mvwputch(g->w_terrain, epicenter.y + i, epicenter.x + i, c_red, '/');
-        for (int j = 1 - i; j < 0 + i; j++) {
-            mvwputch(g->w_terrain, epicenter.y - i, epicenter.x + j, c_red, '-');
-            mvwputch(g->w_terrain, epicenter.y + i, epicenter.x + j, c_red, '-');
-            mvwputch(g->w_terrain, epicenter.y + j, epicenter.x - i, c_red, '|');
-            mvwputch(g->w_terrain, epicenter.y + j, epicenter.x + i, c_red, '|');
-        }
-        wrefresh(g->w_terrain);
-        nanosleep(&ts, nullptr);
-    }
+    animate_blast(*g, *this, radius);
 
     // The rest of the function is shrapnel
     if (shrapnel <= 0) return;
     const zaimoni::gdi::box<point> shrapnel_aoe(point(-2 * radius), point(2 * radius));
-    ts = { 0, BULLET_SPEED };	// Timespec for the animation of bullets
+    std::vector<std::vector<GPS_loc> > flights;
+    const bool animating = animation::enabled();
     for (int i = 0; i < shrapnel; i++) {
         auto dest = *this + rng(shrapnel_aoe);
         auto traj = this->sees(dest, 50);
         if (!traj) continue;
         int dam = rng(20, 60);
-        std::optional<GPS_loc> prev;
+        if (animating) flights.push_back(*traj);
         ptrdiff_t j = traj->size();
         for (decltype(auto) loc : *traj) {
-            if (prev && g->u.see(*prev))
-                g->m.drawsq(g->w_terrain, g->u, *prev, false, true);
-            prev = loc;
             --j;
-            if (g->u.see(loc)) {
-                const point draw_at = std::get<point>(loc - g->u.GPSpos) + point(VIEW_CENTER);
-                mvwputch(g->w_terrain, draw_at.y, draw_at.x, c_red, '`');
-                wrefresh(g->w_terrain);
-                nanosleep(&ts, nullptr);
-            }
             if (auto mob = g->mob_at(loc)) {
                 std::visit(hit_by_shrapnel(dam), *mob);
             } else
                 loc.shoot(dam, 0 == j, 0);
         }
     }
+    animate_shrapnel(*g, flights);
 }
 
 void GPS_loc::sound(int vol, const char* description) const
@@ -3024,8 +3251,7 @@ void game::resonance_cascade(const point& pt)
        case 6:
        case 7: type = fd_nuke_gas; break;
       }
-	  auto& f = m.field_at(k, l);
-      if (f.type == fd_null || !one_in(3)) f = field(type, 3);
+      if (fd_null == m.field_at(k, l).type || !one_in(3)) m.replace_field(field(type, 3), k, l);
      }
     }
     break;
@@ -3062,7 +3288,7 @@ void game::emp_blast(const point& pt)
 {
  int rn;
 
- ter_id& terrain = m.ter(pt);
+ auto terrain = m.ter(pt);
 
  if (is<console>(terrain)) {
   messages.add("The %s is rendered non-functional!", name_of(terrain).c_str());
@@ -3124,17 +3350,15 @@ void game::emp_blast(const point& pt)
 // it is much clearer what is obtained from the Creature class than the Character class (cf. visitor pattern template at visitable.h)
 // diagram: Creature -> monster
 //						Character -> player -> npc
-npc* game::nPC(const point& pt)
+mob_index& game::indexed_mobs()
 {
-	for (auto& m : active_npc) if (m->pos == pt && !m->dead) return m.get();
-	return nullptr;
+    auto& ret = mob_index::get();
+    if (!ret.is_valid(z, active_npc)) ret.rebuild(z, active_npc);
+    return ret;
 }
 
-npc* game::nPC(const GPS_loc& gps)
-{
-    for (auto& m : active_npc) if (m->GPSpos == gps && !m->dead) return m.get();
-    return nullptr;
-}
+npc* game::nPC(const point& pt) { return nPC(overmap::toGPS(pt)); }
+npc* game::nPC(const GPS_loc& gps) { return indexed_mobs().nPC(gps); }
 
 player* game::survivor(const point& pt)
 {
@@ -3148,17 +3372,8 @@ player* game::survivor(const GPS_loc& gps)
     return nPC(gps);
 }
 
-monster* game::mon(const point& pt)
-{
-	for (auto& m : z) if (m.pos == pt && !m.dead) return &m;
-	return nullptr;
-}
-
-monster* game::mon(const GPS_loc& gps)
-{
-    for (auto& m : z) if (m.GPSpos == gps && !m.dead) return &m;
-    return nullptr;
-}
+monster* game::mon(const point& pt) { return mon(overmap::toGPS(pt)); }
+monster* game::mon(const GPS_loc& gps) { return indexed_mobs().mon(gps); }
 
 mobile* game::mob(const GPS_loc& gps)
 {
@@ -3202,11 +3417,15 @@ std::optional<std::vector<std::variant<monster*, npc*, pc*> > > game::mobs_in_ra
 {
     std::vector<std::variant<monster*, npc*, pc*> > ret;
     if (0 >= range || range >= rl_dist(gps, u.GPSpos)) ret.push_back(&u);
-    for (auto& m : active_npc) {
-        if (!m->dead && (0 >= range || range >= rl_dist(gps, m->GPSpos))) ret.push_back(m.get());
-    }
-    for (auto& m : z) {
-        if (!m.dead && (0 >= range || range >= rl_dist(gps, m.GPSpos))) ret.push_back(&m);
+    if (0 >= range) {
+        for (auto& m : active_npc) if (!m->dead) ret.push_back(m.get());
+        for (auto& m : z) if (!m.dead) ret.push_back(&m);
+    } else {
+        std::vector<monster*> mons;
+        std::vector<npc*> npcs;
+        indexed_mobs().in_range(gps, range, mons, npcs);
+        for (auto m : npcs) ret.push_back(m);
+        for (auto m : mons) ret.push_back(m);
     }
     if (!ret.empty()) return ret;
     return std::nullopt;
@@ -3218,15 +3437,15 @@ std::optional<std::vector<std::pair<std::variant<monster*, npc*, pc*>, int> > >
 
     const int dist = rl_dist(gps, u.GPSpos);
     if (0 >= range || range >= dist) ret.push_back(std::pair(&u, dist));
-    for (auto& m : active_npc) {
-        if (m->dead) continue;
-        const int dist = rl_dist(gps, m->GPSpos);
-        if (0 >= range || range >= dist) ret.push_back(std::pair(m.get(), dist));
-    }
-    for (auto& m : z) {
-        if (m.dead) continue;
-        const int dist = rl_dist(gps, m.GPSpos);
-        if (0 >= range || range >= dist) ret.push_back(std::pair(&m, dist));
+    if (0 >= range) {
+        for (auto& m : active_npc) if (!m->dead) ret.push_back(std::pair(m.get(), rl_dist(gps, m->GPSpos)));
+        for (auto& m : z) if (!m.dead) ret.push_back(std::pair(&m, rl_dist(gps, m.GPSpos)));
+    } else {
+        std::vector<monster*> mons;
+        std::vector<npc*> npcs;
+        indexed_mobs().in_range(gps, range, mons, npcs);
+        for (auto m : npcs) ret.push_back(std::pair(m, rl_dist(gps, m->GPSpos)));
+        for (auto m : mons) ret.push_back(std::pair(m, rl_dist(gps, m->GPSpos)));
     }
     if (!ret.empty()) return ret;
     return std::nullopt;
@@ -3278,7 +3497,10 @@ bool game::exec_first(std::function<std::optional<bool>(npc&) > op)
     for (decltype(auto) _npc : active_npc) {
         ++i;
         if (auto code = op(*_npc)) {
-            if (*code) EraseAt(active_npc, i);
+            if (*code) {
+                EraseAt(active_npc, i);
+                mob_index::get().invalidate();
+            }
             return true;
         }
     }
@@ -3288,16 +3510,19 @@ bool game::exec_first(std::function<std::optional<bool>(npc&) > op)
 void game::spawn(npc&& whom)
 {
     active_npc.push_back(std::shared_ptr<npc>(new npc(std::move(whom))));
+    mob_index::get().invalidate();
 }
 
 void game::spawn(const monster& whom)
 {
     z.push_back(whom);
+    mob_index::get().invalidate();
 }
 
 void game::spawn(monster&& whom)
 {
     z.push_back(std::move(whom));
+    mob_index::get().invalidate();
 }
 
 bool game::is_empty(const point& pt) const
@@ -3566,7 +3791,7 @@ void game::examine()
  exam += u.pos;
  messages.add("That is a %s.", name_of(m.ter(exam)).c_str());
 
- auto& exam_t = m.ter(exam);
+ auto exam_t = m.ter(exam);
  auto& stack = m.i_at(exam);
 
  if (const auto v = m._veh_at(exam)) {
@@ -4589,7 +4814,7 @@ void game::butcher()
 void game::eat()
 {
  if (u.has_trait(PF_RUMINANT)) {
-     ter_id& terrain = u.GPSpos.ter();
+     auto terrain = u.GPSpos.ter();
      if (t_underbrush == terrain && query_yn("Eat underbrush?")) {
          u.moves -= 4 * mobile::mp_turn;
          u.hunger -= 10;
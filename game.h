@@ -22,13 +22,11 @@ static_assert(mobile::mp_turn == calendar::mp_turn);
 // daylight should view almost the entire reality bubble, at least until Earth's curvature matters
 static_assert(DAYLIGHT_LEVEL == (MAPSIZE / 2) * SEE);
 
-#define BULLET_SPEED 10000000
-#define EXPLOSION_SPEED 70000000
-
 #define PICKUP_RANGE 2
 
 struct constructable;
 struct special_game;
+class mob_index;
 
 enum tut_type {
  TUT_NULL,
@@ -74,6 +72,7 @@ class game : public reality_bubble
   game();
   ~game();
   void setup();
+  bool setup(const std::string& name);	// without the menus: loads save/name.sav, or starts a random character if name is empty
   bool game_quit() const { return QUIT_MENU == uquit; }; // True if we actually quit the game - used in main.cpp
   void save();
   bool do_turn();
@@ -229,6 +228,7 @@ class game : public reality_bubble
 
  private:
 // Game-start procedures
+  void reset();	// everything from the previous game, before a new one starts or loads
   bool opening_screen();// Warn about screen size, then present the main menu
   bool load_master();	// Load the master data file, with factions &c
   void load(std::string name);	// Load a player-specific save file
@@ -293,6 +293,8 @@ class game : public reality_bubble
                             const std::vector<const monster*>& t, int& target,
                             const std::string& prompt);
 
+  mob_index& indexed_mobs();	// mob_index::get(), rebuilt if z or active_npc changed
+
 // Map updating and monster spawning
   void replace_stair_monsters();
   void update_stair_monsters();
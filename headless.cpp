@@ -0,0 +1,304 @@
+#if HEADLESS
+
+/* Main loop for the headless simulation: no terminal, a fixed seed, and the player following a script */
+
+#include "headless.hpp"
+#include "game.h"
+#include "keypress.h"
+#include "mapbuffer.h"
+#include "profiler.hpp"
+#include "recent_msg.h"
+#include "savefile.hpp"
+#include "savepack.hpp"
+#include "wrap_curses.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+headless& headless::get()
+{
+	static headless ooao;
+	return ooao;
+}
+
+void headless::push(int ch, size_t count)
+{
+	while (0 < count--) _script.push_back(ch);
+}
+
+bool headless::load_script(const std::string& src)
+{
+	std::ifstream fin(src.c_str());
+	if (!fin.is_open()) {
+		std::cerr << src << ": cannot open\n";
+		return false;
+	}
+	bool ok = true;
+	int line_no = 0;
+	std::string line;
+	while (std::getline(fin, line)) {
+		line_no++;
+		const auto comment = line.find('#');
+		if (std::string::npos != comment) line.erase(comment);
+		std::istringstream tokens(line);
+		std::string what;
+		if (!(tokens >> what)) continue;
+		int ch = 0;
+		if ("key" == what) {
+			char c;
+			if (tokens >> c) ch = c;
+		} else if (const auto act = look_up_action(what)) {
+			const auto bound = keys.translate(act);
+			if (!bound.empty()) ch = bound.front();
+		}
+		if (!ch) {
+			std::cerr << src << ":" << line_no << ": no key for \"" << what << "\"\n";
+			ok = false;
+			continue;
+		}
+		size_t count = 1;
+		if (!(tokens >> count)) count = 1;
+		push(ch, count);
+	}
+	return ok;
+}
+
+int headless::key(bool input)
+{
+	const int turn = int(messages.turn);
+	if (turn != _turn) {
+		_turn = turn;
+		_reads = 0;
+	}
+	if (stuck_limit < ++_reads) {
+		std::cerr << "headless: " << stuck_limit << " keys read on turn " << turn << " without it ending; stuck in a prompt?\n";
+		exit(EXIT_FAILURE);
+	}
+
+	if (!_script.empty()) {
+		const int ret = _script.front();
+		_script.pop_front();
+		_scripted++;
+		return ret;
+	}
+	if (input) {
+		const auto bound = keys.translate(ACTION_PAUSE);
+		if (!bound.empty()) return bound.front();
+	}
+	// dismisses popups (escape), debug messages (space), menus (first option), and says yes (upper case: OPT_FORCE_YN)
+	static constexpr const int cycle[] = { KEY_ESCAPE, ' ', '\n', '1', 'Y' };
+	_prompts++;
+	return cycle[_cycle++ % (sizeof(cycle) / sizeof(*cycle))];
+}
+
+// summarizes the state of the world; identical runs agree
+static unsigned long long state_hash(const game& g)
+{
+	unsigned long long ret = 14695981039346656037ULL;	// FNV-1a
+	const auto mix = [&](long long x) {
+		for (int i = 0; i < 8; i++) {
+			ret ^= (unsigned char)(x >> (8 * i));
+			ret *= 1099511628211ULL;
+		}
+	};
+	const auto mix_loc = [&](const GPS_loc& loc) {
+		mix(loc.first.x);
+		mix(loc.first.y);
+		mix(loc.first.z);
+		mix(loc.second.x);
+		mix(loc.second.y);
+	};
+	mix(int(messages.turn));
+	mix_loc(g.u.GPSpos);
+	for (int i = 0; i < num_hp_parts; i++) mix(g.u.hp_cur[i]);
+	mix(g.u.hunger);
+	mix(g.u.thirst);
+	mix(g.u.fatigue);
+	mix(g.u.inv.size());
+	mix(g.z.size());
+	for (const auto& _mon : g.z) {
+		mix(_mon.type->id);
+		mix_loc(_mon.GPSpos);
+		mix(_mon.hp);
+	}
+	mix(g.active_npc.size());
+	for (const auto& _npc : g.active_npc) {
+		mix_loc(_npc->GPSpos);
+		for (int i = 0; i < num_hp_parts; i++) mix(_npc->hp_cur[i]);
+	}
+	return ret;
+}
+
+static long peak_rss_kib()
+{
+#ifdef _WIN32
+	return -1;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage)) return -1;
+	return usage.ru_maxrss;	// KiB on Linux
+#endif
+}
+
+// savepack over src, and over damaged copies of its container, which must not decode
+static void check_savepack(const std::string& name, const std::string& src, int& failed)
+{
+	using namespace cataclysm;
+	const auto fail = [&](const std::string& why) {
+		std::cerr << "selftest: savepack, " << name << ": " << why << "\n";
+		failed++;
+	};
+	const std::string packed = savepack::pack(src);
+	try {
+		if (savepack::unpack(packed) != src) fail("does not unpack to what was packed");
+	} catch (const std::exception& e) {
+		fail(e.what());
+		return;
+	}
+	std::string damaged(packed);
+	damaged[damaged.size() / 2] ^= 0x5A;
+	try {
+		savepack::unpack(damaged);
+		fail("a damaged byte went unnoticed");
+	} catch (const std::exception&) {}
+	try {
+		savepack::unpack(packed.substr(0, packed.size() - 1));
+		fail("truncation went unnoticed");
+	} catch (const std::exception&) {}
+}
+
+// the save formats, after the run: every resident submap through the text and binary encodings, then the savepack
+// container over their text and over its edge cases.  Failures are reported on std::cerr; returns how many.
+static int selftest()
+{
+	int failed = 0;
+	std::string corpus;
+	size_t text_bytes = 0;
+	size_t binary_bytes = 0;
+	const auto resident = MAPBUFFER.sorted();
+	for (const auto& x : resident) {
+		size_t text_len, binary_len;
+		if (!x.second->check_round_trip(text_len, binary_len)) {
+			std::cerr << "selftest: submap (" << x.first.x << "," << x.first.y << "," << x.first.z << ") does not round-trip\n";
+			failed++;
+		}
+		text_bytes += text_len;
+		binary_bytes += binary_len;
+		std::ostringstream os;
+		os << *x.second;
+		corpus += os.str();
+	}
+	if (resident.empty()) {
+		std::cerr << "selftest: no resident submaps to check\n";
+		failed++;
+	}
+
+	static constexpr const size_t record = cataclysm::savepack::record_size;
+	std::string noise(record + 1, '\0');	// incompressible; stored as-is
+	unsigned int lcg = 1;
+	for (auto& c : noise) c = char((lcg = lcg * 1103515245U + 12345U) >> 24);
+	check_savepack("submaps", corpus, failed);
+	check_savepack("empty", std::string(), failed);
+	check_savepack("one record", std::string(record, 'x'), failed);
+	check_savepack("just over one record", std::string(record + 1, 'x'), failed);
+	check_savepack("noise", noise, failed);
+
+	std::cout << "selftest: " << resident.size() << " submaps, " << text_bytes << " bytes as text, " << binary_bytes << " as binary; "
+		<< corpus.size() << " bytes through savepack; " << failed << " failed\n";
+	return failed;
+}
+
+static void usage()
+{
+	std::cerr << "cataclysm-sim [--seed N] [--turns N] [--script FILE] [--load NAME] [--csv FILE] [--selftest]\n\
+Runs the game without a terminal.  Without --load, a new world and random character are generated from the seed;\n\
+run it in a directory whose save/ is empty (make bench does).  Once the script runs out, the player waits.\n\
+--selftest then checks the save formats round-trip, and fails if they do not (make check does).\n";
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int seed = 1;
+	long turns = 1000;
+	std::string script;
+	std::string load;
+	std::string csv;
+	bool check = false;
+	for (int i = 1; i < argc; i++) {
+		const bool have_value = i + 1 < argc;
+		if (!strcmp(argv[i], "--seed") && have_value) seed = strtoul(argv[++i], nullptr, 10);
+		else if (!strcmp(argv[i], "--turns") && have_value) turns = strtol(argv[++i], nullptr, 10);
+		else if (!strcmp(argv[i], "--script") && have_value) script = argv[++i];
+		else if (!strcmp(argv[i], "--load") && have_value) load = argv[++i];
+		else if (!strcmp(argv[i], "--csv") && have_value) csv = argv[++i];
+		else if (!strcmp(argv[i], "--selftest")) check = true;
+		else {
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (load.empty() && std::ifstream("save/master.gsav").is_open()) {
+		std::cerr << "save/ already holds a world; a new one would not be reproducible\n";
+		return EXIT_FAILURE;
+	}
+
+	srand(seed);
+	initscr();
+	init_colors();
+
+	std::unique_ptr<game> g(new game);	// loads the keymap, which the script needs
+	if (load.empty()) {	// finish the random character, with a random name
+		headless::get().push('>');
+		headless::get().push('Y');
+	}
+	if (!script.empty() && !headless::get().load_script(script)) return EXIT_FAILURE;
+	MAPBUFFER.load();
+	if (!g->setup(load)) {
+		std::cerr << (load.empty() ? std::string("cannot start a new game") : "cannot load " + load) << "\n";
+		return EXIT_FAILURE;
+	}
+
+	profiler::get().reset();
+	profiler::get().enabled = true;
+	const int start_turn = int(messages.turn);
+	const auto start = std::chrono::steady_clock::now();
+	long ran = 0;
+	bool over = false;
+	try {
+		while (ran < turns) {
+			if ((over = g->do_turn())) break;
+			ran++;
+		}
+	} catch (const std::exception& e) {	// the debug build's logic checks; reproducible from the same seed
+		std::cerr << "turn " << int(messages.turn) << ": " << e.what() << "\n";
+		savefile::get().drain();
+		return EXIT_FAILURE;
+	}
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	profiler::get().enabled = false;
+	savefile::get().drain();
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "seed " << seed << ": " << ran << " turns (" << start_turn << " to " << int(messages.turn) << ")"
+		<< (over ? ", game over" : "") << "\n";
+	std::cout << elapsed.count() * 1e3 << " ms, " << (0 < elapsed.count() ? ran / elapsed.count() : 0.0) << " turns/second\n";
+	const long rss = peak_rss_kib();
+	if (0 <= rss) std::cout << "peak RSS " << rss << " KiB\n";
+	std::cout << headless::get().scripted() << " scripted keys, " << headless::get().prompts() << " prompts answered\n";
+	std::cout << "state " << std::hex << std::setw(16) << std::setfill('0') << state_hash(*g) << std::dec << std::setfill(' ') << "\n\n";
+	std::cout << profiler::get().report();
+	if (!csv.empty() && !profiler::get().write_csv(csv)) std::cerr << csv << ": cannot write\n";
+	const bool passed = !check || !selftest();
+	endwin();
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
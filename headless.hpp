@@ -0,0 +1,45 @@
+#ifndef HEADLESS_HPP
+#define HEADLESS_HPP 1
+
+#include <deque>
+#include <string>
+
+// singleton
+// Keyboard for the headless simulation (cataclysm-sim, built with HEADLESS and the null curses backend).
+// Keys come from a script first.  Once it is used up, the game's own input() is told to wait (the pause key), and
+// anything else reading the keyboard is a prompt, answered from a fixed cycle that gets past popups, menus and y/n
+// questions.  Everything is a function of the script, so runs with the same seed and script are identical.
+class headless
+{
+public:
+	static constexpr const size_t stuck_limit = 10000;	// keys read without a turn passing, before giving up
+
+private:
+	std::deque<int> _script;
+	size_t _scripted;	// keys served from the script
+	size_t _prompts;	// keys served from the prompt cycle
+	size_t _cycle;
+	int _turn;	// as of the last key read
+	size_t _reads;	// since _turn changed
+
+	headless() : _scripted(0), _prompts(0), _cycle(0), _turn(-1), _reads(0) {}
+	~headless() = default;
+	headless(const headless& src) = delete;
+	headless(headless&& src) = delete;
+	headless& operator=(const headless& src) = delete;
+	headless& operator=(headless&& src) = delete;
+public:
+	static headless& get();
+
+	void push(int ch, size_t count = 1);
+	// one instruction per line: an action name from data/keymap.txt, or "key" and a character; either may be followed
+	// by a repeat count.  # starts a comment.  Errors are reported on std::cerr.
+	bool load_script(const std::string& src);
+	int key(bool input);	// input: the game's input(), rather than a prompt
+
+	size_t scripted() const { return _scripted; }
+	size_t prompts() const { return _prompts; }
+	size_t pending() const { return _script.size(); }
+};
+
+#endif
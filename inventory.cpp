@@ -10,6 +10,7 @@ item& inventory::operator[] (int i)
 {
     assert(0 <= i && items.size() > i);
     assert(!items[i].empty());
+    _stamp.touch();
     return items[i].front();
 }
 
@@ -21,6 +22,13 @@ const item& inventory::operator[] (int i) const
 }
 
 std::vector<item>& inventory::stack_at(int i)
+{
+ assert(0 <= i && items.size() > i);
+ _stamp.touch();
+ return items[i];
+}
+
+const std::vector<item>& inventory::stack_at(int i) const
 {
  assert(0 <= i && items.size() > i);
  return items[i];
@@ -93,6 +101,7 @@ void inventory::add_stack(const std::vector<item>& newits)
 void inventory::_add_item(item&& newit, bool keep_invlet)
 {
     if (newit.is_style()) throw std::logic_error("tried to add style to inventory");
+    _stamp.touch();
     if (keep_invlet && !newit.invlet_is_okay()) assign_empty_invlet(newit); // Keep invlet is true, but invlet is invalid!
 
     for (auto& stack : items) {
@@ -159,12 +168,14 @@ void inventory::destroy_stack(int index)
 {
     assert(0 <= index && items.size() > index);
     EraseAt(items, index);
+    _stamp.touch();
 }
 
 item inventory::remove_item(int index)
 {
  assert(0 <= index && items.size() > index);
 
+ _stamp.touch();
  item ret(std::move(items[index][0]));
  EraseAt(items[index], 0);
  if (items[index].empty()) EraseAt(items, index);
@@ -177,6 +188,7 @@ item inventory::remove_item(int stack, int index)
  assert(0 <= stack && items.size() > stack);
  assert(0 <= index && items[stack].size() > index);
 
+ _stamp.touch();
  item ret = std::move(items[stack][index]);
  EraseAt(items[stack], index);
  if (items[stack].empty()) EraseAt(items, stack);
@@ -248,6 +260,7 @@ int inventory::charges_of(itype_id it) const
 
 void inventory::use_amount(itype_id it, int quantity, bool use_container)
 {
+ _stamp.touch();
  for (int i = 0; i < items.size() && quantity > 0; i++) {
   for (int j = 0; j < items[i].size() && quantity > 0; j++) {
 // First, check contents
@@ -286,6 +299,7 @@ void inventory::use_amount(itype_id it, int quantity, bool use_container)
 unsigned int inventory::use_charges(itype_id it, int quantity)
 {
     const int start_qty = quantity;
+    _stamp.touch();
 
     ptrdiff_t i = items.size();
     while (0 < --i) {
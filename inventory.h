@@ -14,6 +14,30 @@ struct GPS_loc;
 class inventory
 {
  public:
+  // changes whenever the items may have; never reused, so equal stamps mean equal contents
+  class stamp {
+	  unsigned long long _x;
+
+	  static unsigned long long next() {
+		  static unsigned long long ooao = 0;
+		  return ++ooao;
+	  }
+  public:
+	  stamp() noexcept : _x(next()) {}
+	  stamp(const stamp& src) = default;
+	  stamp(stamp&& src) noexcept : _x(src._x) { src.touch(); }
+	  ~stamp() = default;
+	  stamp& operator=(const stamp& src) = default;
+	  stamp& operator=(stamp&& src) noexcept {
+		  _x = src._x;
+		  src.touch();
+		  return *this;
+	  }
+
+	  void touch() noexcept { _x = next(); }
+	  operator unsigned long long() const { return _x; }
+  };
+
   inventory() = default;
   inventory(const cataclysm::JSON& src);
   inventory(const inventory& src) = default;
@@ -28,10 +52,11 @@ class inventory
   item& operator[] (int i);
   const item& operator[] (int i) const;
   std::vector<item>& stack_at(int i);
-  const std::vector<item>& stack_at(int i) const { return const_cast<inventory*>(this)->stack_at(i); };
+  const std::vector<item>& stack_at(int i) const;
   std::vector<item> const_stack(int i) const;
 // std::vector<item> as_vector();	// dead function
   size_t size() const { return items.size(); }
+  unsigned long long version() const { return _stamp; }
   int num_items() const;
 
   inventory& operator+= (const inventory &rhs);
@@ -41,7 +66,10 @@ class inventory
   inventory  operator+  (const item &rhs) const;
   inventory  operator+  (const std::vector<item> &rhs) const;
 
-  void clear() { items.clear(); }
+  void clear() {
+	  items.clear();
+	  _stamp.touch();
+  }
   void add_stack(const std::vector<item>& newits);
 #if DEAD_FUNC
   void push_back(const std::vector<item>& newits) { add_stack(newits); }
@@ -81,6 +109,7 @@ class inventory
 
  private:
   std::vector< std::vector<item> > items;
+  stamp _stamp;	// touched by everything that can change items, including non-const access
 
   void assign_empty_invlet(item &it, player* p = nullptr);
   void _add_item(item&& newit, bool keep_invlet);
@@ -48,7 +48,7 @@ std::string item_drop_spec::to_s() const
 #define TECH(t) types[index]->techniques = t
 
 // retain C-namespacing here as we expect to be installing tiles for items
-static const char* JSON_transcode_items[] = {
+static constexpr const char* JSON_transcode_items[] = {
 	"itm_corpse",
 	"itm_fire",
 	"itm_toolset",
@@ -632,7 +632,7 @@ static const char* JSON_transcode_items[] = {
 	"itm_style_zui_quan"
 };
 
-static const char* const JSON_transcode_ammo[] = {
+static constexpr const char* JSON_transcode_ammo[] = {
 	"BATT",
 	"PLUT",
 	"NAIL",
@@ -728,10 +728,10 @@ namespace cataclysm {
 
 	itype_id JSON_parse<itype_id>::operator()(const char* const src)
 	{
-		if (!src || !src[0]) return itype_id(0);
-		ptrdiff_t i = sizeof(JSON_transcode_items) / sizeof(*JSON_transcode_items);	\
-		while (0 < i--) if (!strcmp(JSON_transcode_items[i], src)) return itype_id(i + JSON_parse<itype_id>::origin);	\
-		return itype_id(0);
+		static constexpr const enum_hash::table<sizeof(JSON_transcode_items) / sizeof(*JSON_transcode_items)> index(JSON_transcode_items);
+		static_assert(index.round_trip(JSON_transcode_items), "itype_id JSON keys do not round-trip");
+		const auto i = index.find(JSON_transcode_items, src);
+		return 0 <= i ? itype_id(i + JSON_parse<itype_id>::origin) : itype_id(0);
 	}
 }
 
@@ -874,7 +874,7 @@ void iuse::hammer(pc& p, item& it)
   return;
  }
 
- auto& type = g->m.ter(dir + p.pos);
+ auto type = g->m.ter(dir + p.pos);
  auto deconstruct = linear_search(type, std::begin(deconstruct_boarded), std::end(deconstruct_boarded));
  if (!deconstruct) {
      messages.add("Hammers can only remove boards from windows and doors.");
@@ -1088,7 +1088,7 @@ void iuse::crowbar(pc& p, item& it)
   return;
  }
 
- auto& type = g->m.ter(dir + p.pos);
+ auto type = g->m.ter(dir + p.pos);
  if (type == t_door_c || type == t_door_locked || type == t_door_locked_alarm) {
   if (dice(4, 6) < dice(4, p.str_cur)) {
    messages.add("You pry the door open.");
@@ -3,11 +3,227 @@
 #include <stdexcept>
 #include <istream>
 #include <sstream>
+#include <algorithm>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace cataclysm {
 
 std::map<std::string, JSON> JSON::cache;
 const std::string JSON::discard_s;
+const JSON JSON::discard;
+
+// node storage
+namespace {
+
+struct JSON_slabs {
+	static constexpr const size_t node = 32;	// std::string, the largest node type
+	static constexpr const size_t slab = 64 * 1024;
+	static constexpr const size_t batch = 4096;	// free nodes a thread keeps before sharing them
+	static constexpr const std::align_val_t align{slab};	// so a node's slab is its address, rounded down
+
+	void* free_list = nullptr;
+	size_t free_count = 0;
+	char* next = nullptr;
+	char* end = nullptr;
+
+	static char* slab_of(const void* src) { return reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(src) & ~uintptr_t(slab - 1)); }
+};
+
+// A thread's slab is only released by JSON_trim, once it is fully carved and every node of it is in a shared batch
+// or the trimming thread's free list.
+thread_local JSON_slabs slabs;
+
+// Full free lists, for whichever thread runs dry next.  Trees built on one thread are often destroyed on another
+// (the save writer), so without this the freeing thread would hoard the nodes.
+struct JSON_returned {
+	std::mutex lock;
+	std::vector<std::pair<void*, size_t> > batches;
+	std::atomic<size_t> available{0};	// batches.size(), readable without the lock
+	std::unordered_set<char*> carved;	// slabs no thread is still carving nodes from
+
+	static JSON_returned& get() {
+		static JSON_returned& ooao = *new JSON_returned();	// never destroyed: threads may free nodes during static destruction
+		return ooao;
+	}
+};
+
+}
+
+void* JSON_node_alloc(size_t n)
+{
+	if (JSON_slabs::node < n) return ::operator new(n);
+	auto& pool = slabs;
+	if (!pool.free_list) {
+		auto& shared = JSON_returned::get();
+		if (shared.available.load(std::memory_order_relaxed)) {
+			std::lock_guard<std::mutex> guard(shared.lock);
+			if (!shared.batches.empty()) {
+				pool.free_list = shared.batches.back().first;
+				pool.free_count = shared.batches.back().second;
+				shared.batches.pop_back();
+				shared.available.store(shared.batches.size(), std::memory_order_relaxed);
+			}
+		}
+	}
+	if (pool.free_list) {
+		void* const ret = pool.free_list;
+		pool.free_list = *reinterpret_cast<void**>(ret);
+		pool.free_count--;
+		return ret;
+	}
+	if (pool.next == pool.end) {
+		if (pool.end) {
+			auto& shared = JSON_returned::get();
+			std::lock_guard<std::mutex> guard(shared.lock);
+			shared.carved.insert(pool.end - JSON_slabs::slab);
+		}
+		pool.next = static_cast<char*>(::operator new(JSON_slabs::slab, JSON_slabs::align));
+		pool.end = pool.next + JSON_slabs::slab;
+	}
+	void* const ret = pool.next;
+	pool.next += JSON_slabs::node;
+	return ret;
+}
+
+void JSON_node_free(void* src, size_t n)
+{
+	if (!src) return;
+	if (JSON_slabs::node < n) {
+		::operator delete(src);
+		return;
+	}
+	auto& pool = slabs;
+	*reinterpret_cast<void**>(src) = pool.free_list;
+	pool.free_list = src;
+	if (JSON_slabs::batch <= ++pool.free_count) {
+		auto& shared = JSON_returned::get();
+		std::lock_guard<std::mutex> guard(shared.lock);
+		shared.batches.push_back(std::pair(pool.free_list, pool.free_count));
+		shared.available.store(shared.batches.size(), std::memory_order_relaxed);
+		pool.free_list = nullptr;
+		pool.free_count = 0;
+	}
+}
+
+size_t JSON_trim()
+{
+	static constexpr const size_t per_slab = JSON_slabs::slab / JSON_slabs::node;
+
+	auto& pool = slabs;
+	auto& shared = JSON_returned::get();
+	std::lock_guard<std::mutex> guard(shared.lock);
+	std::vector<std::pair<void*, size_t> > lists(std::move(shared.batches));
+	shared.batches.clear();
+	if (pool.free_list) lists.push_back(std::pair(pool.free_list, pool.free_count));
+	pool.free_list = nullptr;
+	pool.free_count = 0;
+
+	std::unordered_map<char*, size_t> unused;	// free nodes per carved slab
+	for (const auto& list : lists) {
+		for (void* x = list.first; x; x = *reinterpret_cast<void**>(x)) {
+			const auto src = JSON_slabs::slab_of(x);
+			if (shared.carved.count(src)) unused[src]++;
+		}
+	}
+
+	// re-batch the nodes of slabs still in use; unlink first, as releasing a slab takes its nodes' links with it
+	std::pair<void*, size_t> keep(nullptr, 0);
+	for (const auto& list : lists) {
+		void* x = list.first;
+		while (x) {
+			void* const next = *reinterpret_cast<void**>(x);
+			const auto src = unused.find(JSON_slabs::slab_of(x));
+			if (unused.end() == src || per_slab > src->second) {
+				*reinterpret_cast<void**>(x) = keep.first;
+				keep.first = x;
+				if (JSON_slabs::batch <= ++keep.second) {
+					shared.batches.push_back(keep);
+					keep = std::pair(nullptr, 0);
+				}
+			}
+			x = next;
+		}
+	}
+	if (keep.first) shared.batches.push_back(keep);
+	shared.available.store(shared.batches.size(), std::memory_order_relaxed);
+
+	size_t ret = 0;
+	for (const auto& x : unused) {
+		if (per_slab > x.second) continue;
+		shared.carved.erase(x.first);
+		::operator delete(x.first, JSON_slabs::align);
+		ret += JSON_slabs::slab;
+	}
+	return ret;
+}
+
+const std::string* JSON_object::intern(const std::string& key)
+{
+	static std::mutex lock;
+	static std::unordered_set<std::string> keys;	// node-based: addresses survive rehashing
+
+	std::lock_guard<std::mutex> guard(lock);
+	return &*keys.insert(key).first;
+}
+
+JSON_object::iterator JSON_object::lower_bound(const std::string& key)
+{
+	return std::lower_bound(_x.begin(), _x.end(), key, [](const value_type& lhs, const std::string& rhs) { return *lhs.first < rhs; });
+}
+
+JSON_object::const_iterator JSON_object::lower_bound(const std::string& key) const
+{
+	return std::lower_bound(_x.begin(), _x.end(), key, [](const value_type& lhs, const std::string& rhs) { return *lhs.first < rhs; });
+}
+
+JSON* JSON_object::find(const std::string& key)
+{
+	auto it = lower_bound(key);
+	if (_x.end() == it || *it->first != key) return nullptr;
+	return &it->second;
+}
+
+const JSON* JSON_object::find(const std::string& key) const
+{
+	auto it = lower_bound(key);
+	if (_x.end() == it || *it->first != key) return nullptr;
+	return &it->second;
+}
+
+JSON& JSON_object::operator[](const std::string& key)
+{
+	// our own writer emits keys in order, so reading back appends
+	if (_x.empty() || *_x.back().first < key) {
+		_x.emplace_back(intern(key), JSON());
+		return _x.back().second;
+	}
+	auto it = lower_bound(key);
+	if (_x.end() != it && *it->first == key) return it->second;
+	return _x.emplace(it, intern(key), JSON())->second;
+}
+
+void JSON_object::erase(const std::string& key)
+{
+	auto it = lower_bound(key);
+	if (_x.end() != it && *it->first == key) _x.erase(it);
+}
+
+void JSON_object::shrink_to_fit()
+{
+	_x.shrink_to_fit();
+}
+
+const JSON& JSON::operator[](const std::string& key) const
+{
+	if (object != _mode || !_object) return discard;
+	const JSON* const ret = _object->find(key);
+	return ret ? *ret : discard;
+}
 
 bool JSON::syntax_ok() const
 {
@@ -81,7 +297,7 @@ void JSON::push(const JSON& src)
 		reset();
 		_mode = array;
 	}
-	if (!_array) _array = new std::vector<JSON>();
+	if (!_array) _array = new JSON_array();
 	_array->push_back(src);
 }
 
@@ -91,7 +307,7 @@ void JSON::push(JSON&& src)
 		reset();
 		_mode = array;
 	}
-	if (!_array) _array = new std::vector<JSON>();
+	if (!_array) _array = new JSON_array();
 	_array->push_back(std::move(src));
 }
 
@@ -110,7 +326,7 @@ JSON JSON::grep(bool (ok)(const JSON&)) const
 		{
 		_object_JSON conserve;
 		for (const auto& tmp : *_object) {
-			if (ok(tmp.second)) conserve[tmp.first] = tmp.second;
+			if (ok(tmp.second)) conserve[*tmp.first] = tmp.second;
 		}
 		if (conserve.empty()) return ret;
 		ret._mode = object;
@@ -125,7 +341,7 @@ JSON JSON::grep(bool (ok)(const JSON&)) const
 		}
 		if (conserve.empty()) return ret;
 		ret._mode = array;
-		ret._array = new std::vector<JSON>(std::move(conserve));
+		ret._array = new JSON_array(std::move(conserve));
 		}
 		return ret;
 	}
@@ -143,7 +359,7 @@ bool JSON::destructive_grep(bool (ok)(const JSON&))
 		{
 			std::vector<std::string> doomed;
 			for (const auto& tmp : *_object) {
-				if (!ok(tmp.second)) doomed.push_back(tmp.first);
+				if (!ok(tmp.second)) doomed.push_back(*tmp.first);
 			}
 			for (const auto& tmp : doomed) _object->erase(tmp);
 		}
@@ -176,7 +392,7 @@ bool JSON::destructive_grep(bool (ok)(const std::string& key, const JSON&), bool
 	// assume we have RAM, etc.
 	std::vector<std::string> keys;
 	for (const auto& iter : *_object) {
-		if (!ok(iter.first,iter.second)) keys.push_back(iter.first);
+		if (!ok(*iter.first,iter.second)) keys.push_back(*iter.first);
 	}
 	for (const auto& key : keys) {
 		if (!postprocess(key, (*_object)[key])) _object->erase(key);
@@ -204,7 +420,7 @@ bool JSON::destructive_merge(JSON& src)
 	} else {
 		// copy src._object values to existing object
 		for (auto& iter : *src._object) {
-			(*_object)[iter.first] = std::move(iter.second);
+			(*_object)[*iter.first] = std::move(iter.second);
 		}
 		delete src._object;
 	}
@@ -230,7 +446,7 @@ bool JSON::destructive_merge(JSON& src, bool (ok)(const JSON&))
 	// assume we have RAM, etc.
 	std::vector<std::string> keys;
 	for (const auto& iter : *src._object) {
-		if (ok(iter.second)) keys.push_back(iter.first);
+		if (ok(iter.second)) keys.push_back(*iter.first);
 	}
 	for (const auto& key : keys) {
 		(*_object)[key] = std::move((*src._object)[key]);
@@ -247,7 +463,7 @@ std::vector<std::string> JSON::keys() const
 {
 	std::vector<std::string> ret;
 	if (object == _mode && _object) {
-		for (const auto& iter : *_object) ret.push_back(iter.first);
+		for (const auto& iter : *_object) ret.push_back(*iter.first);
 	}
 	return ret;
 }
@@ -306,6 +522,15 @@ void JSON::set(const std::string& src, JSON&& val)
 }
 
 // constructor and support thereof
+JSON::JSON(std::string*& src, bool is_literal)
+: _scalar(nullptr), _mode(is_literal ? literal : string)
+{
+	if (!src) return;
+	_scalar = new JSON_scalar(std::move(*src));
+	delete src;
+	src = nullptr;
+}
+
 JSON::JSON(const JSON& src)
 : _scalar(nullptr), _mode(src._mode)
 {
@@ -315,11 +540,11 @@ JSON::JSON(const JSON& src)
 		_object = src._object ? new _object_JSON(*src._object) : nullptr;
 		break;
 	case array:
-		_array = src._array ? new std::vector<JSON>(*src._array) : nullptr;
+		_array = src._array ? new JSON_array(*src._array) : nullptr;
 		break;
 	case string:
 	case literal:
-		_scalar = src._scalar ? new std::string(*src._scalar) : nullptr;
+		_scalar = src._scalar ? new JSON_scalar(*src._scalar) : nullptr;
 		break;
 	case none: break;
 	default: throw std::runtime_error("invalid JSON src for copy");
@@ -530,11 +755,13 @@ void JSON::finish_reading_object(std::istream& src, unsigned long& line)
 		dest[_key.scalar()] = std::move(_value);
 		if (!consume_whitespace(src, line)) {	// oops, at end prematurely (but everything that did arrive is ok)
 			_mode = object;
+			dest.shrink_to_fit();
 			_object = dest.empty() ? nullptr : new _object_JSON(std::move(dest));
 			return;
 		}
 		if (next_is(src, '}')) {
 			_mode = object;
+			dest.shrink_to_fit();
 			_object = dest.empty() ? nullptr : new _object_JSON(std::move(dest));
 			return;
 		}
@@ -576,12 +803,12 @@ void JSON::finish_reading_array(std::istream& src, unsigned long& line)
 		}
 		if (!consume_whitespace(src, line)) {	// early end but data so far ok
 			_mode = array;
-			_array = dest.empty() ? nullptr : new std::vector<JSON>(std::move(dest));
+			_array = dest.empty() ? nullptr : new JSON_array(std::move(dest));
 			return;
 		}
 		if (next_is(src, ']')) {	// array terminated legally{
 			_mode = array;
-			_array = dest.empty() ? nullptr : new std::vector<JSON>(std::move(dest));
+			_array = dest.empty() ? nullptr : new JSON_array(std::move(dest));
 			return;
 		}
 		if (!next_is(src, ',')) {
@@ -592,9 +819,10 @@ void JSON::finish_reading_array(std::istream& src, unsigned long& line)
 	} while (true);
 }
 
-void JSON::finish_reading_string(std::istream& src, unsigned long& line, char& first)
+// shared with JSON_reader; opening quote already consumed
+static void read_string(std::istream& src, std::string& dest, char& first)
 {
-	std::string dest;
+	dest.clear();
 	bool in_escape = false;
 
 	do {
@@ -647,9 +875,6 @@ void JSON::finish_reading_string(std::istream& src, unsigned long& line, char& f
 		}
 		dest += first;
 	} while (!src.eof());
-	// done
-	_mode = string;
-	_scalar = new std::string(std::move(dest));
 }
 
 static const char* reject_for_JSON_literal(char c)
@@ -657,9 +882,10 @@ static const char* reject_for_JSON_literal(char c)
 	return strchr(" \r\n\t\v\f{}[],:\"", c);
 }
 
-void JSON::finish_reading_literal(std::istream& src, unsigned long& line, char& first)
+// shared with JSON_reader; first is the already-consumed first character
+static void read_literal(std::istream& src, std::string& dest, char& first)
 {
-	std::string dest;
+	dest.clear();
 	dest += first;
 
 	do {
@@ -669,9 +895,146 @@ void JSON::finish_reading_literal(std::istream& src, unsigned long& line, char&
 		src.get(first);
 		dest += first;
 	} while(!src.eof());
+}
+
+void JSON::finish_reading_string(std::istream& src, unsigned long& line, char& first)
+{
+	std::string dest;
+	read_string(src, dest, first);
+	// done
+	_mode = string;
+	_scalar = new JSON_scalar(std::move(dest));
+}
+
+void JSON::finish_reading_literal(std::istream& src, unsigned long& line, char& first)
+{
+	std::string dest;
+	read_literal(src, dest, first);
 	// done
 	_mode = literal;
-	_scalar = new std::string(std::move(dest));
+	_scalar = new JSON_scalar(std::move(dest));
+}
+
+// JSON_reader
+static const std::string JSON_reader_failed("JSON read failed, line: ");
+
+[[noreturn]] static void reader_failed(const std::string& msg, unsigned long line)
+{
+	std::ostringstream tmp;
+	tmp << msg << line;
+	throw std::runtime_error(tmp.str());
+}
+
+JSON_reader::JSON_reader(std::istream& src)
+: _src(src), _old_exceptions(src.exceptions()), _line(1)
+{
+	_src.exceptions(std::ios::badbit);	// throw on hardware failure
+}
+
+JSON_reader::~JSON_reader()
+{
+	try {
+		_src.exceptions(_old_exceptions);
+	} catch (const std::ios::failure&) {	// the caller's mask covers the stream's current state; it will find out
+	}
+}
+
+unsigned char JSON_reader::mode()
+{
+	if (!consume_whitespace(_src, _line)) return JSON::none;
+	switch (_src.peek())
+	{
+	case '{': return JSON::object;
+	case '[': return JSON::array;
+	case '"': return JSON::string;
+	case ',':
+	case '}':
+	case ']':
+	case ':': return JSON::none;
+	default: return JSON::literal;
+	}
+}
+
+bool JSON_reader::begin_object()
+{
+	if (JSON::object != mode()) return false;
+	_src.get();
+	_first.push_back(true);
+	return true;
+}
+
+bool JSON_reader::begin_array()
+{
+	if (JSON::array != mode()) return false;
+	_src.get();
+	_first.push_back(true);
+	return true;
+}
+
+// as the tree reader: running out of data closes whatever is open
+bool JSON_reader::next_in(char close)
+{
+	if (!consume_whitespace(_src, _line) || next_is(_src, close)) {
+		_first.pop_back();
+		return false;
+	}
+	if (_first.back()) _first.back() = false;
+	else if (!next_is(_src, ',')) reader_failed(std::string("JSON read failed, expected , or ") + close + ", line: ", _line);
+	return true;
+}
+
+bool JSON_reader::next_key()
+{
+	if (!next_in('}')) return false;
+	if (!consume_whitespace(_src, _line)) reader_failed(JSON_object_read_truncated, _line);
+	char first;
+	switch (scan_for_data_start(_src, first, _line))
+	{
+	case JSON::string:
+		read_string(_src, _key, first);
+		break;
+	case JSON::literal:
+		read_literal(_src, _key, first);
+		break;
+	default: reader_failed(JSON_object_read_failed, _line);	// object needs a string or literal as its key
+	}
+	if (!consume_whitespace(_src, _line)) reader_failed(JSON_object_read_truncated, _line);
+	if (!next_is(_src, ':')) reader_failed("JSON read of object failed, expected :, line: ", _line);
+	if (!consume_whitespace(_src, _line)) reader_failed(JSON_object_read_truncated, _line);
+	return true;
+}
+
+bool JSON_reader::next_element()
+{
+	return next_in(']');
+}
+
+bool JSON_reader::scalar()
+{
+	const auto code = mode();
+	if (JSON::string != code && JSON::literal != code) return false;
+	char first;
+	scan_for_data_start(_src, first, _line);
+	if (JSON::string == code) read_string(_src, _scalar, first);
+	else read_literal(_src, _scalar, first);
+	return true;
+}
+
+void JSON_reader::skip()
+{
+	if (begin_object()) {
+		while (next_key()) skip();
+	} else if (begin_array()) {
+		while (next_element()) skip();
+	} else if (!scalar()) reader_failed(JSON_reader_failed, _line);
+}
+
+JSON JSON_reader::value()
+{
+	char last_read = ' ';
+	JSON ret(_src, _line, last_read);
+	if (JSON::none == ret.mode()) reader_failed(JSON_reader_failed, _line);
+	return ret;
 }
 
 static const char* escape_for_JSON_string(char c)
@@ -758,7 +1121,7 @@ std::ostream& JSON::write_object(std::ostream& os, const _object_JSON& src, int
 	const auto ub = src.size();
 	auto i = 0;
 	for (const auto& x : src) {
-		write_literal(os, x.first);
+		write_literal(os, *x.first);
 		os.put(':');
 		x.second.write(os, indent + 1);
 		if (++i < ub) {
@@ -861,3 +1224,61 @@ bool fromJSON(const JSON& src, bool& dest)
 cataclysm::JSON toJSON(int src) {
 	return JSON(std::to_string(src));
 }
+
+bool fromJSON(cataclysm::JSON_reader& src, std::string& dest)
+{
+	if (!src.scalar()) {
+		src.skip();
+		return false;
+	}
+	dest = src.scalar_value();
+	return true;
+}
+
+bool fromJSON(cataclysm::JSON_reader& src, int& dest)
+{
+	if (!src.scalar()) {
+		src.skip();
+		return false;
+	}
+	dest = stoll(src.scalar_value());
+	return true;
+}
+
+bool fromJSON(cataclysm::JSON_reader& src, unsigned int& dest)
+{
+	if (!src.scalar()) {
+		src.skip();
+		return false;
+	}
+	dest = stoull(src.scalar_value());
+	return true;
+}
+
+bool fromJSON(cataclysm::JSON_reader& src, char& dest)
+{
+	if (!src.scalar()) {
+		src.skip();
+		return false;
+	}
+	dest = src.scalar_value()[0];
+	return true;
+}
+
+bool fromJSON(cataclysm::JSON_reader& src, bool& dest)
+{
+	if (!src.scalar()) {
+		src.skip();
+		return false;
+	}
+	const auto& x = src.scalar_value();
+	if ("false" == x) {
+		dest = false;
+		return true;
+	}
+	if ("true" == x) {
+		dest = true;
+		return true;
+	}
+	return false;
+}
@@ -17,6 +17,7 @@
 namespace cataclysm {
 
 class JSON;
+class JSON_reader;
 
 }
 
@@ -26,10 +27,80 @@ bool fromJSON(const cataclysm::JSON& src, unsigned int& dest);
 bool fromJSON(const cataclysm::JSON& src, char& dest);
 bool fromJSON(const cataclysm::JSON& src, bool& dest);
 
+// streaming counterparts; anything without one is read as a JSON value and handed to the overload above
+bool fromJSON(cataclysm::JSON_reader& src, std::string& dest);
+bool fromJSON(cataclysm::JSON_reader& src, int& dest);
+bool fromJSON(cataclysm::JSON_reader& src, unsigned int& dest);
+bool fromJSON(cataclysm::JSON_reader& src, char& dest);
+bool fromJSON(cataclysm::JSON_reader& src, bool& dest);
+template<class T> bool fromJSON(cataclysm::JSON_reader& src, T& dest);
+
 cataclysm::JSON toJSON(int src);
 
 namespace cataclysm {
 
+// Storage behind JSON values.  These small fixed-size nodes are carved from per-thread slabs rather than
+// individually from the heap; freed nodes are reused by whichever thread frees them.
+void* JSON_node_alloc(size_t n);
+void JSON_node_free(void* src, size_t n);
+size_t JSON_trim();	// returns wholly free slabs to the heap; bytes released
+
+#define JSON_NODE_ALLOCATION	\
+	static void* operator new(size_t n) { return JSON_node_alloc(n); }	\
+	static void operator delete(void* src, size_t n) { JSON_node_free(src, n); }
+
+struct JSON_scalar : public std::string
+{
+	using std::string::string;
+	JSON_scalar(const std::string& src) : std::string(src) {}
+	JSON_scalar(std::string&& src) : std::string(std::move(src)) {}
+	JSON_NODE_ALLOCATION
+};
+
+struct JSON_array : public std::vector<JSON>
+{
+	JSON_array() = default;
+	JSON_array(const std::vector<JSON>& src);
+	JSON_array(std::vector<JSON>&& src);
+	JSON_NODE_ALLOCATION
+};
+
+// Flat, key-sorted object storage.  Keys are interned: the same few dozen key names recur across a save file.
+// As with std::vector, inserting a key invalidates references to the other values.
+class JSON_object
+{
+public:
+	typedef std::pair<const std::string*, JSON> value_type;
+	typedef std::vector<value_type>::iterator iterator;
+	typedef std::vector<value_type>::const_iterator const_iterator;
+
+private:
+	std::vector<value_type> _x;
+
+	iterator lower_bound(const std::string& key);
+	const_iterator lower_bound(const std::string& key) const;
+public:
+	static const std::string* intern(const std::string& key);
+
+	iterator begin() { return _x.begin(); }
+	iterator end() { return _x.end(); }
+	const_iterator begin() const { return _x.begin(); }
+	const_iterator end() const { return _x.end(); }
+	size_t size() const { return _x.size(); }
+	bool empty() const { return _x.empty(); }
+
+	JSON* find(const std::string& key);
+	const JSON* find(const std::string& key) const;
+	size_t count(const std::string& key) const { return find(key) ? 1 : 0; }
+	JSON& operator[](const std::string& key);
+	void erase(const std::string& key);
+	void shrink_to_fit();
+
+	JSON_NODE_ALLOCATION
+};
+
+#undef JSON_NODE_ALLOCATION
+
 class JSON
 {
 public:
@@ -44,12 +115,13 @@ public:
 	};
 
 private:
-	typedef std::map<std::string, JSON> _object_JSON;
+	typedef JSON_object _object_JSON;
 	static const std::string discard_s;
+	static const JSON discard;
 
 	union {
-		std::string* _scalar;
-		std::vector<JSON>* _array;
+		JSON_scalar* _scalar;
+		JSON_array* _array;
 		_object_JSON* _object;
 	};
 	unsigned char _mode;
@@ -59,10 +131,10 @@ public:
 	JSON(const JSON& src);
 	JSON(JSON&& src) noexcept;
 	JSON(std::istream& src);
-	JSON(const std::string& src) : _scalar(new std::string(src)), _mode(literal) {}
-	JSON(std::string&& src) : _scalar(new std::string(std::move(src))), _mode(literal) {}
-	JSON(const char* src, bool is_literal = true) : _scalar(new std::string(src)), _mode(is_literal ? literal : string) {}
-	JSON(std::string*& src, bool is_literal = true) : _scalar(src), _mode(is_literal ? literal : string) { src = nullptr; }
+	JSON(const std::string& src) : _scalar(new JSON_scalar(src)), _mode(literal) {}
+	JSON(std::string&& src) : _scalar(new JSON_scalar(std::move(src))), _mode(literal) {}
+	JSON(const char* src, bool is_literal = true) : _scalar(new JSON_scalar(src)), _mode(is_literal ? literal : string) {}
+	JSON(std::string*& src, bool is_literal = true);
 	~JSON() { reset(); }
 	friend std::ostream& operator<<(std::ostream& os, const JSON& src);
 
@@ -89,16 +161,18 @@ public:
 	// \todo consider alternate API for has_key that returns JSON* instead
 	bool has_key(const std::string& key) const { return object == _mode && _object && _object->count(key); }
 	JSON& operator[](const std::string& key) { return (*_object)[key]; }
-	const JSON& operator[](const std::string& key) const { return (*_object)[key]; }
+	const JSON& operator[](const std::string& key) const;	// missing keys read as none, and are not added
 	bool become_key(const std::string& key) {
-		if (!has_key(key)) return false;
-		JSON tmp(std::move((*_object)[key]));
+		JSON* const src = (object == _mode && _object) ? _object->find(key) : nullptr;
+		if (!src) return false;
+		JSON tmp(std::move(*src));
 		*this = std::move(tmp);
 		return true;
 	}
 	bool extract_key(const std::string& key, JSON& dest) {
-		if (!has_key(key)) return false;
-		dest = std::move((*_object)[key]);
+		JSON* const src = (object == _mode && _object) ? _object->find(key) : nullptr;
+		if (!src) return false;
+		dest = std::move(*src);
 		unset(key);
 		return true;
 	}
@@ -125,7 +199,7 @@ public:
 	template<class T> static JSON encode(const std::vector<std::shared_ptr<T> >& src) {
 		JSON ret(array);
 		if (!src.empty()) {
-			ret._array = new std::vector<JSON>();
+			ret._array = new JSON_array();
 			for (const auto& x : src) {
 				if (x) ret._array->push_back(toJSON(*x));
 			}
@@ -136,7 +210,7 @@ public:
 	template<class T> static JSON encode(const std::vector<T>& src) {
 		JSON ret(array);
 		if (!src.empty()) {
-			ret._array = new std::vector<JSON>();
+			ret._array = new JSON_array();
 			for (const auto& x : src) ret._array->push_back(toJSON(x));
 		}
 		return ret;
@@ -145,7 +219,7 @@ public:
 	template<class T> static JSON encode(const T* src, size_t n) {
 		JSON ret(array);
 		if (src && 0 < n) {
-			ret._array = new std::vector<JSON>();
+			ret._array = new JSON_array();
 			size_t i = 0;
 			do ret._array->push_back(toJSON(src[i]));
 			while (++i < n);
@@ -173,7 +247,7 @@ public:
 			do {
 				if (dest[i]) {
 					if (auto json = JSON_key((Key)(i))) {
-						if (!ret._array) ret._array = new std::vector<JSON>();
+						if (!ret._array) ret._array = new JSON_array();
 						ret._array->push_back(json);
 					}
 				}
@@ -251,7 +325,7 @@ public:
 		cataclysm::JSON_parse<Key> parse;
 		bool ok = true;
 		for (auto& x : *_object) {
-			auto key = parse(x.first);
+			auto key = parse(*x.first);
 			if (cataclysm::JSON_parse<Key>::origin > key) {
 				ok = false;
 				continue;
@@ -281,6 +355,7 @@ public:
 		return ok;
 	}
 
+	friend class JSON_reader;
 protected:
 	JSON(std::istream& src,unsigned long& line, char& first, bool must_be_scalar = false);
 private:
@@ -294,10 +369,13 @@ private:
 	std::ostream& write(std::ostream& os, int indent) const;
 };
 
+inline JSON_array::JSON_array(const std::vector<JSON>& src) : std::vector<JSON>(src) {}
+inline JSON_array::JSON_array(std::vector<JSON>&& src) : std::vector<JSON>(std::move(src)) {}
+
 template<> inline JSON JSON::encode<const char*>(const std::vector<const char*>& src) {
 	JSON ret(array);
 	if (0 < src.size()) {
-		ret._array = new std::vector<JSON>();
+		ret._array = new JSON_array();
 		for (const auto& x : src) {
 			if (x) ret._array->push_back(x);
 		}
@@ -322,6 +400,102 @@ template<> inline bool JSON::decode<const char*>(std::vector<const char*>& dest)
 	return ok;
 }
 
+// Pull reader over the same lenient grammar as JSON(std::istream&), without building a tree.
+// Containers are walked with begin_object/next_key and begin_array/next_element; every value reached that way
+// must be consumed (scalar, skip, value, or a nested walk) before asking for the next one.
+// Like the tree reader, it stops at the end of the value it was asked for, so the stream can carry other data after.
+class JSON_reader
+{
+private:
+	std::istream& _src;
+	const std::ios::iostate _old_exceptions;	// restored on destruction
+	unsigned long _line;
+	std::string _key;
+	std::string _scalar;
+	std::vector<bool> _first;	// per open container: nothing read from it yet
+
+	bool next_in(char close);
+public:
+	JSON_reader(std::istream& src);
+	JSON_reader(const JSON_reader& src) = delete;
+	JSON_reader(JSON_reader&& src) = delete;
+	~JSON_reader();
+	JSON_reader& operator=(const JSON_reader& src) = delete;
+	JSON_reader& operator=(JSON_reader&& src) = delete;
+
+	unsigned char mode();	// of the next value, as JSON::mode(); none at end of data
+	unsigned long line() const { return _line; }
+
+	bool begin_object();	// false, reading nothing, if the next value is not an object
+	bool next_key();	// false once the object is closed
+	const std::string& key() const { return _key; }
+	bool begin_array();
+	bool next_element();	// false once the array is closed
+
+	bool scalar();	// false, reading nothing, if the next value is not a string or literal
+	const std::string& scalar_value() const { return _scalar; }
+	void skip();
+	JSON value();	// the next value as a tree, for fromJSON overloads that have no streaming version
+
+	template<class T> bool decode(std::vector<std::shared_ptr<T> >& dest) {
+		if (!begin_array()) {
+			skip();
+			return false;
+		}
+		bool ok = true;
+		std::vector<std::shared_ptr<T> > working;
+		while (next_element()) {
+			std::shared_ptr<T> tmp(new T());
+			if (fromJSON(*this, *tmp)) working.push_back(tmp);
+			else ok = false;
+		}
+		if (!working.empty()) dest = std::move(working);
+		else if (ok) dest.clear();
+		return ok;
+	}
+
+	template<class T> bool decode(std::vector<T>& dest) {
+		if (!begin_array()) {
+			skip();
+			return false;
+		}
+		bool ok = true;
+		std::vector<T> working;
+		while (next_element()) {
+			T tmp;
+			if (fromJSON(*this, tmp)) working.push_back(std::move(tmp));
+			else ok = false;
+		}
+		if (!working.empty()) dest = std::move(working);
+		else if (ok) dest.clear();
+		return ok;
+	}
+
+	template<class T> bool decode(T* dest, size_t n) {
+		if (!dest || !begin_array()) {
+			skip();
+			return false;
+		}
+		bool ok = true;
+		size_t i = 0;
+		while (next_element()) {
+			if (i < n) {
+				if (!fromJSON(*this, dest[i])) ok = false;
+			} else {
+				skip();
+				ok = false;
+			}
+			i++;
+		}
+		return ok && i == n;
+	}
+};
+
 }	// namespace cataclysm
 
+template<class T> bool fromJSON(cataclysm::JSON_reader& src, T& dest)
+{
+	return fromJSON(src.value(), dest);
+}
+
 #endif
@@ -1,12 +1,19 @@
 #include "keypress.h"
 #include "wrap_curses.h"
+#if HEADLESS
+#include "headless.hpp"
+#endif
 
 keymap<action_id> keys;
 
 /// <summary>mostly translates arrow keys to vi-keys</summary>
 int input()
 {
+#if HEADLESS
+ int ch = headless::get().key(true);
+#else
  int ch = getch();
+#endif
  switch (ch) {
   case KEY_UP:    return 'k';
   case KEY_LEFT:  return 'h';
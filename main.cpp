@@ -5,6 +5,7 @@
 #include "mapbuffer.h"
 #include "file.h"
 #include "json.h"
+#include "savefile.hpp"
 #include <time.h>
 #include <fstream>
 #include <iostream>
@@ -173,7 +174,8 @@ int main(int argc, char *argv[])
   if (g->game_quit())
    quit_game = true;
  } while (!quit_game);
- MAPBUFFER.save();
+ MAPBUFFER.save(g->m.loaded_submaps());
+ savefile::get().drain();
  erase(); // Clear screen
  endwin(); // End ncurses
 #if HAVE_MS_COM
@@ -4,13 +4,16 @@
 #include "game.h"
 #include "line.h"
 #include "mapbuffer.h"
-#include "posix_time.h"
+#include "animation.hpp"
 #include "json.h"
 #include "recent_msg.h"
 #include "om_cache.hpp"
+#include "profiler.hpp"
 #include "stl_limits.h"
 #include "inline_stack.hpp"
 #include "fragment.inc/rng_box.hpp"
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <cmath>
@@ -34,6 +37,108 @@ enum astar_list {
  ASL_CLOSED
 };
 
+// A* scratch space for map::route.  Pooled across calls: a cell whose stamp is not the current generation
+// is implicitly ASL_NONE, so starting a new search is O(1) rather than re-initializing (SEE*MAPSIZE)^2 cells.
+class astar_scratch
+{
+public:
+	static constexpr const int span = SEE * MAPSIZE;
+
+	struct node {
+		unsigned int stamp;
+		astar_list list;
+		int score;
+		int gscore;
+		unsigned int seq;	// insertion order into the open list; tie-breaker matching the historical linear scan
+		point parent;
+	};
+
+	// open list entry; may be stale (superseded by a better score, or already closed)
+	struct open_entry {
+		int score;
+		unsigned int seq;
+		point pt;
+
+		// std::push_heap et al. build a max-heap; invert so the best (lowest score, then earliest inserted) is on top
+		friend bool operator<(const open_entry& lhs, const open_entry& rhs) {
+			if (lhs.score != rhs.score) return lhs.score > rhs.score;
+			return lhs.seq > rhs.seq;
+		}
+	};
+
+private:
+	std::vector<node> _nodes;
+	std::vector<open_entry> _open;
+	unsigned int _generation;
+	unsigned int _next_seq;
+	size_t _open_count;
+
+	astar_scratch() : _nodes(span * span, node{0, ASL_NONE, 0, 0, 0, point(-1, -1)}), _generation(0), _next_seq(0), _open_count(0) {}
+	astar_scratch(const astar_scratch& src) = delete;
+	astar_scratch(astar_scratch&& src) = delete;
+	~astar_scratch() = default;
+	astar_scratch& operator=(const astar_scratch& src) = delete;
+	astar_scratch& operator=(astar_scratch&& src) = delete;
+
+public:
+	static astar_scratch& get() {
+		static astar_scratch ooao;
+		return ooao;
+	}
+
+	void reset() {
+		if (0 == ++_generation) {	// wrapped: stale stamps could alias the new generation
+			for (auto& n : _nodes) n.stamp = 0;
+			_generation = 1;
+		}
+		_open.clear();
+		_next_seq = 0;
+		_open_count = 0;
+	}
+
+	node& operator[](const point& pt) {
+		auto& ret = _nodes[pt.x * span + pt.y];
+		if (_generation != ret.stamp) {
+			ret.stamp = _generation;
+			ret.list = ASL_NONE;
+			ret.score = 0;
+			ret.gscore = 0;
+			ret.parent = point(-1, -1);
+		}
+		return ret;
+	}
+
+	bool empty() const { return 0 >= _open_count; }
+
+	void open(const point& pt, node& n) {
+		n.list = ASL_OPEN;
+		n.seq = _next_seq++;
+		_open_count++;
+		push(pt, n);
+	}
+
+	// re-queue after a score improvement; the older entry goes stale
+	void push(const point& pt, const node& n) {
+		_open.push_back(open_entry{ n.score, n.seq, pt });
+		std::push_heap(_open.begin(), _open.end());
+	}
+
+	point pop() {
+		while (true) {
+			std::pop_heap(_open.begin(), _open.end());
+			const open_entry ret = _open.back();
+			_open.pop_back();
+			const node& n = (*this)[ret.pt];
+			if (ASL_OPEN == n.list && n.score == ret.score) return ret.pt;
+		}
+	}
+
+	void close(node& n) {
+		n.list = ASL_CLOSED;
+		_open_count--;
+	}
+};
+
 GPS_loc map::toGPS(const reality_bubble_loc& origin) const
 {
     return grid[origin.first]->toGPS(origin.second, Badge<map>());
@@ -120,26 +225,29 @@ std::optional<std::pair<const vehicle*, int>> map::veh_at(const reality_bubble_l
 
 std::optional<std::pair<vehicle*, int>> map::veh_at(const reality_bubble_loc& src)
 {
-    GPS_loc origin = grid[src.first]->toGPS(src.second, Badge<map>());
-    // must check 3x3 map chunks, as vehicle part may span to neighbour chunk
-    // we presume that vehicles don't intersect (they shouldn't by any means)
-    const auto nonant_ub = my_MAPSIZE * my_MAPSIZE;
-    for (int mx = -1; mx <= 1; mx++) {
-        // C:Z: disallow wraparound to next row N/S of ours
-        if (-1 == mx && 0 ==  src.first    % my_MAPSIZE) continue;
-        if ( 1 == mx && 0 == (src.first+1) % my_MAPSIZE) continue;
-        for (int my = -1; my <= 1; my++) {
-            int nonant1 = src.first + mx + my * my_MAPSIZE;
-            if (nonant1 < 0 || nonant1 >= nonant_ub) continue; // out of grid
-            if (auto ret = grid[nonant1]->veh_at(origin)) return ret;
-        }
-    }
-    return std::nullopt;
+    // build_tiles records the part on each tile, from the 3x3 map chunks around it
+    if (!(tile(src).flags & tile_summary::TILE_VEHICLE)) return std::nullopt;
+    const tile_slice& slice = _tiles[src.first];
+    return std::pair(slice.veh[src.second.x][src.second.y], slice.part[src.second.x][src.second.y]);
+}
+
+std::optional<reality_bubble_loc> map::veh_indexed(const GPS_loc& loc) const
+{
+    const auto pos = to(loc);
+    if (!pos) return std::nullopt;
+    // edge chunks can have parts of vehicles parked outside the reality bubble
+    const int gx = pos->first % my_MAPSIZE;
+    const int gy = pos->first / my_MAPSIZE;
+    if (1 > gx || my_MAPSIZE - 1 <= gx || 1 > gy || my_MAPSIZE - 1 <= gy) return std::nullopt;
+    return pos;
 }
 
 // \todo if map::veh_at goes dead code then relocate (overmap.cpp? new GPS_loc.cpp?)
 std::optional<std::pair<vehicle*, int>> GPS_loc::veh_at() const
 {
+    auto& m = game::active()->m;
+    if (const auto pos = m.veh_indexed(*this)) return m.veh_at(*pos);
+
     // must check 3x3 map chunks, as vehicle part may span to neighbour chunk
     // we presume that vehicles don't intersect (they shouldn't by any means)
     submap* const local_map[3][3] = { {MAPBUFFER.lookup_submap(first + Direction::NW), MAPBUFFER.lookup_submap(first + Direction::N), MAPBUFFER.lookup_submap(first + Direction::NE)},
@@ -264,13 +372,15 @@ bool map::displace_vehicle(std::shared_ptr<vehicle> veh, const point& delta, boo
   }
  }
  for (auto& part : veh->parts) part.precalc_d[0] = part.precalc_d[1];
+ vehicles_moved(veh->GPSpos);
 
  // not going off-grid
  if (dest_sm) {
      veh->GPSpos = dest_gps;
      if (src_sm != dest_sm) {
          dest_sm->add(veh, Badge<map>());
-         src_sm->destroy(*veh);
+         src_sm->destroy(*veh, Badge<map>());
+         vehicles_moved(veh->GPSpos);
      }
  }
 
@@ -284,6 +394,29 @@ bool map::displace_vehicle(std::shared_ptr<vehicle> veh, const point& delta, boo
  return (src_sm != dest_sm) || was_update;
 }
 
+void map::vehicles_moved(const GPS_loc& origin)
+{   // build_tiles and GPS_loc::veh_at look for vehicles one chunk away, so that is as far as a footprint can reach
+    const auto pos = to(origin);
+    if (!pos) return;
+    const int n = pos->first;
+    const auto nonant_ub = my_MAPSIZE * my_MAPSIZE;
+    for (int mx = -1; mx <= 1; mx++) {
+        if (-1 == mx && 0 == n % my_MAPSIZE) continue;
+        if ( 1 == mx && 0 == (n + 1) % my_MAPSIZE) continue;
+        for (int my = -1; my <= 1; my++) {
+            const int nonant = n + mx + my * my_MAPSIZE;
+            if (nonant < 0 || nonant >= nonant_ub) continue; // out of grid
+            if (grid[nonant]) grid[nonant]->vehicles_moved();
+        }
+    }
+}
+
+void map::remove_vehicle(vehicle& veh)
+{
+    vehicles_moved(veh.GPSpos);	// first: the chunk may hold the last reference to veh
+    if (submap* const sm = chunk(veh.GPSpos)) sm->destroy(veh, Badge<map>());
+}
+
 void map::vehmove(game *g)
 {
  submap::proxy_vehicles_t vehicles_to_move;
@@ -306,14 +439,14 @@ void map::vehmove(game *g)
      submap* const sm = chunk(veh->GPSpos);
      if (!sm) continue; // \todo probable error condition
      // \todo look at wheels instead?  following is C:Whales
-     auto terrain = veh->GPSpos.ter();
+     ter_id terrain = veh->GPSpos.ter();
      const int mv_cost_terrain = move_cost_of(terrain);
      if (0 >= mv_cost_terrain) { // deducting from moves will fail
          if (is<swimmable>(terrain)) { // deep water
              if (pl_ctrl) messages.add("Your %s sank.", veh->name.c_str());
              veh->unboard_all();
              // destroy vehicle (sank to nowhere)
-             sm->destroy(*veh);
+             remove_vehicle(*veh);
              continue;
          }
          // failover
@@ -327,7 +460,7 @@ void map::vehmove(game *g)
          veh->velocity += veh->velocity < 0 ? 20 * vehicle::mph_1 : -20 * vehicle::mph_1;
          for (const int p : veh->external_parts) {
              auto origin = veh->GPSpos + veh->parts[p].precalc_d[0];
-             ter_id& pter = origin.ter();
+             auto pter = origin.ter();
              if (pter == t_dirt || pter == t_grass) pter = t_dirtmound;
          }
      } // !veh->valid_wheel_config()
@@ -427,10 +560,7 @@ void map::vehmove(game *g)
          veh->velocity -= slowdown;
      if (abs(veh->velocity) < vehicle::mph_1) veh->stop();
 
-     if (pl_ctrl) {
-         timespec ts = { 0, 50000000 };   // Timespec for the animation
-         nanosleep(&ts, nullptr);
-     }
+     if (pl_ctrl) animation(g->w_terrain, animation::FLIGHT).hold();	// the redraw below is the frame
 
      if (can_move) {
          veh->physical_facing(mdir); // accept new direction
@@ -455,7 +585,7 @@ void map::vehmove(game *g)
 
 bool GPS_loc::displace_water()
 {
-    ter_id& terrain = ter();
+    auto terrain = ter();
     if (0 < move_cost_of(terrain) && is<swimmable>(terrain)) // shallow water
     { // displace it
         inline_stack<GPS_loc, std::end(Direction::vector) - std::begin(Direction::vector)> can_displace_to;
@@ -481,7 +611,7 @@ bool GPS_loc::displace_water()
 
 bool map::displace_water(const point& pt)
 {
-    ter_id& origin_terrain = ter(pt);
+    auto origin_terrain = ter(pt);
     if (0 < move_cost_of(origin_terrain) && is<swimmable>(origin_terrain)) // shallow water
     { // displace it
         inline_stack<point, std::end(Direction::vector) - std::begin(Direction::vector)> can_displace_to;
@@ -506,10 +636,10 @@ bool map::displace_water(const point& pt)
     return false;
 }
 
-ter_id& GPS_loc::ter()
+ter_ref GPS_loc::ter()
 {
     if (submap* const sm = game::active()->m.chunk(*this)) return sm->terrain(second);
-    return (discard<ter_id>::x = t_null); // Out-of-bounds - null terrain
+    return ter_ref(nullptr, discard<ter_id>::x = t_null); // Out-of-bounds - null terrain
 }
 
 ter_id GPS_loc::ter() const
@@ -518,19 +648,26 @@ ter_id GPS_loc::ter() const
     return t_null; // Out-of-bounds - null terrain
 }
 
-ter_id& map::ter(int x, int y)
+ter_ref map::ter(int x, int y)
 {
     if (const auto pos = to(x, y)) return grid[pos->first]->terrain(pos->second);
-    return (discard<ter_id>::x = t_null); // Out-of-bounds - null terrain
+    return ter_ref(nullptr, discard<ter_id>::x = t_null); // Out-of-bounds - null terrain
 }
 
-ter_id& map::ter(const reality_bubble_loc& src) { return grid[src.first]->terrain(src.second); };
+ter_ref map::ter(const reality_bubble_loc& src) { return grid[src.first]->terrain(src.second); };
+ter_id map::ter(const reality_bubble_loc& src) const { return static_cast<const submap*>(grid[src.first])->terrain(src.second); }
+
+ter_id map::ter(int x, int y) const
+{
+    if (const auto pos = to(x, y)) return ter(*pos);
+    return t_null; // Out-of-bounds - null terrain
+}
 
 void map::_translate(ter_id from, ter_id to)
 {
 	for (int x = 0; x < SEEX * my_MAPSIZE; x++) {
 		for (int y = 0; y < SEEY * my_MAPSIZE; y++) {
-			auto& t = ter(x, y);
+			auto t = ter(x, y);
 			if (from == t) t = to;
 		}
 	}
@@ -552,8 +689,78 @@ std::string map::features(const point& pt) const
  return ret;
 }
 
+const map::tile_summary& map::tile(const reality_bubble_loc& pos) const
+{
+    if (_tiles.size() != grid.size()) _tiles.assign(grid.size(), tile_slice());
+    const tile_slice& slice = _tiles[pos.first];
+    const submap* const sm = grid[pos.first];
+    if (slice.source != sm || slice.revision != sm->tile_revision() || slice.vehicles != sm->vehicle_tile_revision()) build_tiles(pos.first);
+    return slice.tiles[pos.second.x][pos.second.y];
+}
+
+void map::build_tiles(int n) const
+{
+    const submap* const sm = grid[n];
+    tile_slice& dest = _tiles[n];
+    point pt;
+    for (pt.x = 0; pt.x < SEEX; pt.x++) {
+        for (pt.y = 0; pt.y < SEEY; pt.y++) {
+            const ter_id terrain = sm->terrain(pt);
+            auto& summary = dest.tiles[pt.x][pt.y];
+            summary.move_cost = ter_t::list[terrain].movecost;
+            summary.flags = 0;
+            if (is<transparent>(terrain)) summary.flags |= tile_summary::TILE_TRANSPARENT;
+            if (is<bashable>(terrain)) summary.flags |= tile_summary::TILE_BASHABLE;
+        }
+    }
+
+    // flag and record every tile an external part is on, from the 3x3 chunk neighborhood
+    const tripoint origin = sm->toGPS(point(0), Badge<map>()).first;
+    const auto nonant_ub = my_MAPSIZE * my_MAPSIZE;
+    for (int mx = -1; mx <= 1; mx++) {
+        if (-1 == mx && 0 == n % my_MAPSIZE) continue;
+        if ( 1 == mx && 0 == (n + 1) % my_MAPSIZE) continue;
+        for (int my = -1; my <= 1; my++) {
+            const int nonant = n + mx + my * my_MAPSIZE;
+            if (nonant < 0 || nonant >= nonant_ub) continue; // out of grid
+            for (decltype(auto) veh : grid[nonant]->vehicles_here(Badge<map>())) {
+                for (const int p : veh->external_parts) {
+                    const GPS_loc loc = veh->GPSpos + veh->parts[p].precalc_d[0];
+                    if (origin != loc.first) continue;
+                    auto& flags = dest.tiles[loc.second.x][loc.second.y].flags;
+                    if (flags & tile_summary::TILE_VEHICLE) continue;   // vehicles should not overlap; first found wins
+                    flags |= tile_summary::TILE_VEHICLE;
+                    dest.veh[loc.second.x][loc.second.y] = veh.get();
+                    dest.part[loc.second.x][loc.second.y] = p;
+                }
+            }
+        }
+    }
+
+    dest.source = sm;
+    dest.revision = sm->tile_revision();
+    dest.vehicles = sm->vehicle_tile_revision();
+}
+
+void map::forget_tiles(int n)
+{
+    if (_tiles.size() != grid.size()) return;
+    const auto nonant_ub = my_MAPSIZE * my_MAPSIZE;
+    for (int mx = -1; mx <= 1; mx++) {
+        if (-1 == mx && 0 == n % my_MAPSIZE) continue;
+        if ( 1 == mx && 0 == (n + 1) % my_MAPSIZE) continue;
+        for (int my = -1; my <= 1; my++) {
+            const int nonant = n + mx + my * my_MAPSIZE;
+            if (nonant < 0 || nonant >= nonant_ub) continue; // out of grid
+            _tiles[nonant].source = nullptr;
+        }
+    }
+}
+
 int map::move_cost(const reality_bubble_loc& pos) const
 {
+ const tile_summary& summary = tile(pos);
+ if (!(summary.flags & tile_summary::TILE_VEHICLE)) return summary.move_cost;
  if (const auto v = veh_at(pos)) {
      const vehicle* const veh = v->first; // backward compatibility
      int dpart = veh->part_with_feature(v->second, vpf_obstacle);
@@ -564,21 +771,13 @@ int map::move_cost(const reality_bubble_loc& pos) const
          return 8;
  }
 
- return ter_t::list[ter(pos)].movecost;
+ return summary.move_cost;
 }
 
 int map::move_cost(int x, int y) const
 {
- if (const auto v = _veh_at(x, y)) {
-     const vehicle* const veh = v->first;
-     int dpart = veh->part_with_feature(v->second, vpf_obstacle);
-     if (dpart >= 0 &&
-         (!veh->part_flag(dpart, vpf_openable) || !veh->parts[dpart].open))
-         return 0;
-     else
-         return 8;
- }
- return ter_t::list[ter(x, y)].movecost;
+ if (const auto pos = to(x, y)) return move_cost(*pos);
+ return ter_t::list[t_null].movecost;
 }
 
 int GPS_loc::move_cost() const
@@ -621,8 +820,10 @@ bool map::trans(const reality_bubble_loc& pos) const
     // Control statement is a problem. Normally returning false on an out-of-bounds
     // is how we stop rays from going on forever.  Instead we'll have to include
     // this check in the ray loop.
+    const tile_summary& summary = tile(pos);
     bool tertr;
-    if (const auto v = veh_at(pos)) {
+    if (!(summary.flags & tile_summary::TILE_VEHICLE)) tertr = summary.flags & tile_summary::TILE_TRANSPARENT;
+    else if (const auto v = veh_at(pos)) {
         const vehicle* const veh = v->first; // backward compatibility
         tertr = !veh->part_flag(v->second, vpf_opaque) || veh->parts[v->second].hp <= 0;
         if (!tertr) {
@@ -633,7 +834,7 @@ bool map::trans(const reality_bubble_loc& pos) const
     }
     else
         tertr = is<transparent>(ter(pos));
-    const auto& fd = grid[pos.first]->field_at(pos.second);
+    const auto& fd = field_at(pos);
     return tertr && (fd.type == 0 || field::list[fd.type].transparent[fd.density - 1]);	// Fields may obscure the view, too
 }
 
@@ -646,6 +847,8 @@ bool map::trans(const point& pt) const
 bool map::has_flag(t_flag flag, const reality_bubble_loc& pos) const
 {
     if (flag == bashable) {
+        const tile_summary& summary = tile(pos);
+        if (!(summary.flags & tile_summary::TILE_VEHICLE)) return summary.flags & tile_summary::TILE_BASHABLE;
         if (const auto v = veh_at(pos)) {
             const vehicle* const veh = v->first; // backward compatibility
             if (veh->parts[v->second].hp > 0 && // if there's a vehicle part here...
@@ -661,19 +864,8 @@ bool map::has_flag(t_flag flag, const reality_bubble_loc& pos) const
 
 bool map::has_flag(t_flag flag, int x, int y) const
 {
- if (flag == bashable) {
-     if (const auto v = _veh_at(x, y)) {
-         const vehicle* const veh = v->first; // backward compatibility
-         const int vpart = v->second;
-         if (veh->parts[vpart].hp > 0 && // if there's a vehicle part here...
-             veh->part_with_feature(vpart, vpf_obstacle) >= 0) {// & it is obstacle...
-             int p = veh->part_with_feature(vpart, vpf_openable);
-             if (p < 0 || !veh->parts[p].open) // and not open door
-                 return true;
-         }
-     }
- }
- return ter_t::list[ter(x, y)].flags & mfb(flag);
+ if (const auto pos = to(x, y)) return has_flag(flag, *pos);
+ return ter_t::list[t_null].flags & mfb(flag);
 }
 
 bool GPS_loc::is_bashable() const
@@ -1048,7 +1240,7 @@ bool map::bash(int x, int y, int str, std::string &sound, int *res)
 // creatures call map::destroy only if the terrain is NOT bashable.  Map generation usually preemptively bashes.
 void map::destroy(game *g, const point& origin, bool makesound)
 {
- auto& terrain = ter(origin);
+ auto terrain = ter(origin);
 
  // contrary to what one would expect, vehicle destruction not directly processed here
  if (!is_destructible(terrain)) return;
@@ -1111,7 +1303,7 @@ void map::destroy(game *g, const point& origin, bool makesound)
 
 void GPS_loc::destroy(bool makesound)
 {
-    auto& terrain = ter();
+    auto terrain = ter();
 
     // contrary to what one would expect, vehicle destruction not directly processed here
     if (!is_destructible(terrain)) return;
@@ -1186,7 +1378,7 @@ void map::shoot(game *g, const point& pt, int &dam, bool hit_items, unsigned fla
      dam = veh->first->damage(veh->second, dam, inc ? vehicle::damage_type::incendiary : vehicle::damage_type::pierce, hit_items);
  }
 
- switch (ter_id& terrain = ter(pt)) {
+ switch (auto terrain = ter(pt)) {
  case t_wall_wood_broken:
  case t_door_b:
   if (hit_items || one_in(8)) {	// 1 in 8 chance of hitting the door
@@ -1329,7 +1521,7 @@ bool GPS_loc::hit_with_acid()
 {
     if (0 != move_cost()) return false; // Didn't hit the tile!
 
-    switch (auto& t = ter()) {
+    switch (auto t = ter()) {
     case t_wall_glass_v:
     case t_wall_glass_h:
     case t_wall_glass_v_alarm:
@@ -1595,34 +1787,31 @@ bool GPS_loc::hard_landing(item&& thrown, player* p)
     return false;
 }
 
-void submap::process_active_items()
+void submap::_process_active_items()
 {
-    if (0 >= active_item_count) return;
     const auto g = game::active();
-    for (int i = 0; i < SEEX; i++) {
-        for (int j = 0; j < SEEY; j++) {
-            std::vector<item>& items = itm[i][j];
-            size_t n = items.size();
-            while (0 < n) {
-                if (decltype(auto) it = items[--n]; it.active) {
-                    switch (int code = g->u.use_active(it))   // XXX \todo allow modeling active item effects w/o player
-                    { // ignore artifacts/code -2
-                    case -1:   // discharge charger gun
-                        it.active = false;
-                        it.charges = 0;
-                        active_item_count--;
-                        break;
-                    case 1:
-                        EraseAt(items, n);  // reference invalidated
-                        active_item_count--;
-                        break;
-                    case 0:
-                        if (!it.active) active_item_count--;
-                        break;
-                    }
+    std::vector<point> sweep;
+    sweep.swap(active_items);   // items can land here while we work
+    for (const point pt : sweep) {
+        std::vector<item>& items = itm[pt.x][pt.y];
+        bool still_active = false;
+        size_t n = items.size();
+        while (0 < n) {
+            if (decltype(auto) it = items[--n]; it.active) {
+                switch (int code = g->u.use_active(it))   // XXX \todo allow modeling active item effects w/o player
+                { // ignore artifacts/code -2
+                case -1:   // discharge charger gun
+                    it.active = false;
+                    it.charges = 0;
+                    break;
+                case 1:
+                    EraseAt(items, n);  // reference invalidated
+                    continue;
                 }
+                if (it.active) still_active = true;
             }
         }
+        if (still_active) note_active(pt);
     }
 }
 
@@ -1747,7 +1936,9 @@ void map::add_trap(int x, int y, trap_id t)
 }
 
 field& map::field_at(const reality_bubble_loc& src) { return grid[src.first]->field_at(src.second); }
+const field& map::field_at(const reality_bubble_loc& src) const { return static_cast<const submap*>(grid[src.first])->field_at(src.second); }
 void map::remove_field(const reality_bubble_loc& src) { return grid[src.first]->remove_field(src.second); }
+void map::replace_field(const reality_bubble_loc& dest, field&& src) { grid[dest.first]->replace_field(dest.second, std::move(src)); }
 
 bool map::add_field(game *g, int x, int y, field_id t, unsigned char density, unsigned int age)
 {
@@ -1762,6 +1953,11 @@ bool map::add_field(game *g, int x, int y, field_id t, unsigned char density, un
     return false;
 }
 
+void GPS_loc::replace(field&& src)
+{   // intentionally no-op if submap doesn't exist
+    if (submap* const sm = game::active()->m.chunk(*this)) sm->replace_field(second, std::move(src));
+}
+
 // return value is per waterfall/SSADM software lifecycle
 bool GPS_loc::add(field&& src)
 {   // intentionally no-op if submap doesn't exist
@@ -1801,6 +1997,7 @@ void map::debug()
 void map::draw(WINDOW* w, const player& u, point center)
 {
  int light = u.sight_range();
+ const fov_scope frame(*this, u.pos);
  forall_do_inclusive(view_center_extent(), [&](point offset) {
         const point real(center + offset);
         const int dist = rl_dist(u.pos, real);
@@ -1825,7 +2022,7 @@ void map::drawsq(WINDOW* w, const player& u, int x, int y, bool invert, bool sho
     const int k = x + VIEW_CENTER - viewpoint->x;
     const int j = y + VIEW_CENTER - viewpoint->y;
     nc_color tercol;
-    const auto terrain = ter(*pos);
+    const ter_id terrain = ter(*pos);
     long sym = ter_t::list[terrain].sym;
     bool hi = false;
     bool normal_tercol = false;
@@ -1865,7 +2062,7 @@ void map::drawsq(WINDOW* w, const player& u, int x, int y, bool invert, bool sho
         }
     }
     // If there's a field here, draw that instead (unless its symbol is %)
-    const auto& fd = grid[pos->first]->field_at(pos->second);
+    const auto& fd = field_at(*pos);
     if (fd.type != fd_null && field::list[fd.type].sym != '&') {
         tercol = field::list[fd.type].color[fd.density - 1];
         drew_field = true;
@@ -1921,7 +2118,7 @@ void map::drawsq(WINDOW* w, const player& u, GPS_loc dest, bool invert, bool sho
     const auto draw_at = delta_pt + point(VIEW_CENTER);
 
     nc_color tercol;
-    const auto terrain = dest.ter();
+    const ter_id terrain = dest.ter();
     long sym = ter_t::list[terrain].sym;
     bool hi = false;
     bool normal_tercol = false;
@@ -2063,8 +2260,61 @@ std::optional<int> map::_BresenhamLine(int Fx, int Fy, int Tx, int Ty, int range
     return std::nullopt; // Shouldn't ever be reached, but there it is.
 }
 
+map::fov_stats_t map::fov_stats = {};
+
+map::fov_scope::fov_scope(const map& m, const point& viewer) : m(m), owner(!m._fov.active)
+{
+    if (!owner) return; // nested: the outer scope's memo stays authoritative
+    auto& memo = m._fov;
+    const size_t ub = (size_t)m.my_MAPSIZE * m.my_MAPSIZE * SEE * SEE;
+    if (memo.cells.size() != ub) {
+        memo.cells.assign(ub, fov_memo::cell{ 0, 0, 0, false });
+        memo.generation = 0;
+    }
+    if (0 == ++memo.generation) {   // wrapped: stale stamps could alias the new generation
+        for (auto& c : memo.cells) c.los_stamp = c.trans_stamp = 0;
+        memo.generation = 1;
+    }
+    memo.origin = viewer;
+    memo.active = true;
+    fov_stats.scopes++;
+}
+
+map::fov_scope::~fov_scope()
+{
+    if (owner) m._fov.active = false;
+}
+
 std::optional<int> map::sees(int Fx, int Fy, int Tx, int Ty, int range) const
 {
+  profiler::sampled_scope<profiler::SEES, profiler::sees_sample> timing;
+  if (_fov.active && _fov.origin == point(Fx, Fy)) {
+      if (range >= 0 && (abs(Tx - Fx) > range || abs(Ty - Fy) > range)) return std::nullopt;	// Out of range!
+      if (const auto dest = to(Tx, Ty)) {
+          const auto index = [](const reality_bubble_loc& pos) { return (pos.first * SEE + pos.second.x) * SEE + pos.second.y; };
+          auto& memo = _fov.cells[index(*dest)];
+          if (_fov.generation == memo.los_stamp) {
+              fov_stats.hits++;
+              if (INT_MIN == memo.tc) return std::nullopt;
+              return memo.tc;
+          }
+          const auto start = std::chrono::steady_clock::now();
+          // range was checked above, so the search itself is unbounded; transparency is memoized as well
+          const auto ret = _BresenhamLine(Fx, Fy, Tx, Ty, -1, [&](reality_bubble_loc pos) {
+              auto& c = _fov.cells[index(pos)];
+              if (_fov.generation != c.trans_stamp) {
+                  c.trans = trans(pos);
+                  c.trans_stamp = _fov.generation;
+              }
+              return c.trans;
+          });
+          memo.los_stamp = _fov.generation;
+          memo.tc = ret ? *ret : INT_MIN;
+          fov_stats.misses++;
+          fov_stats.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+          return ret;
+      }
+  }
   return _BresenhamLine(Fx, Fy, Tx, Ty, range, [&](reality_bubble_loc pos) { return trans(pos); });
 }
 
@@ -2251,6 +2501,7 @@ bool GPS_loc::can_see(const GPS_loc& dest, int range) const
 // Bash defaults to true.
 std::vector<point> map::route(int Fx, int Fy, int Tx, int Ty, bool bash) const
 {
+ profiler::scope timing(profiler::ROUTE);
 /* TODO: If the origin or destination is out of bound, figure out the closest
  * in-bounds point and go to that, then to the real origin/destination.
  */
@@ -2265,12 +2516,8 @@ std::vector<point> map::route(int Fx, int Fy, int Tx, int Ty, bool bash) const
 // First, check for a simple straight line on flat ground
  if (const auto linet = clear_path(Fx, Fy, Tx, Ty, -1, 2, 2)) return line_to(Fx, Fy, Tx, Ty, *linet);
 
- std::vector<point> open;
- // Zaimoni: we're taking a memory management hit converting from C99 stack-allocated arrays to std::vector here.
- std::vector<std::vector<astar_list> > list(SEEX * my_MAPSIZE, std::vector<astar_list>(SEEY * my_MAPSIZE, ASL_NONE)); // Init to not being on any list
- std::vector<std::vector<int> > score(SEEX * my_MAPSIZE, std::vector<int>(SEEY * my_MAPSIZE, 0));	// No score!
- std::vector<std::vector<int> > gscore(SEEX * my_MAPSIZE, std::vector<int>(SEEY * my_MAPSIZE, 0));	// No score!
- std::vector<std::vector<point> > parent(SEEX * my_MAPSIZE, std::vector<point>(SEEY * my_MAPSIZE, point(-1, -1)));
+ auto& scratch = astar_scratch::get();
+ scratch.reset();
 
  int startx = Fx - 4, endx = Tx + 4, starty = Fy - 4, endy = Ty + 4;
  if (Tx < Fx) {
@@ -2290,49 +2537,45 @@ std::vector<point> map::route(int Fx, int Fy, int Tx, int Ty, bool bash) const
  if (endy > SEEY * my_MAPSIZE - 1)
   endy = SEEY * my_MAPSIZE - 1;
 
- list[Fx][Fy] = ASL_OPEN;
- open.push_back(point(Fx, Fy));
+ const point F(Fx, Fy);
+ const point T(Tx, Ty);
+ scratch.open(F, scratch[F]);
 
  bool done = false;
 
  do {
-  int best = INT_MAX;
-  int index = -1;
-  for (int i = 0; i < open.size(); i++) {
-   if (score[open[i].x][open[i].y] < best) {
-    best = score[open[i].x][open[i].y];
-    index = i;
-   }
-  }
+  const point cur = scratch.pop();
+  auto& cur_node = scratch[cur];
   for (decltype(auto) dir_vec : Direction::vector) {
-      const point dest = open[index] + dir_vec;
-      if (dest.x == Tx && dest.y == Ty) {
+      const point dest = cur + dir_vec;
+      if (dest == T) {
           done = true;
-          parent[dest.x][dest.y] = open[index];
+          scratch[dest].parent = cur;
       } else if (dest.x >= startx && dest.x <= endx && dest.y >= starty && dest.y <= endy) {
           const int mv_cost = move_cost(dest);
           const bool can_destroy = bash && has_flag(bashable, dest);
           if (0 < mv_cost || can_destroy) {
               decltype(auto) gcost = [&]() {
-                  int new_g = gscore[open[index].x][open[index].y] + mv_cost;
+                  int new_g = cur_node.gscore + mv_cost;
                   if (ter(dest) == t_door_c) new_g += 4;	// A turn to open it and a turn to move there
                   else if (0 == mv_cost && can_destroy) new_g += 18;	// Worst case scenario with damage penalty
                   return new_g;
               };
 
-              switch(auto& asl_mode = list[dest.x][dest.y]) {
+              auto& dest_node = scratch[dest];
+              switch(dest_node.list) {
               case ASL_NONE: // Not listed, so make it open
-                  asl_mode = ASL_OPEN;
-                  open.push_back(dest);
-                  parent[dest.x][dest.y] = open[index];
-                  gscore[dest.x][dest.y] = gcost();
-                  score[dest.x][dest.y] = gscore[dest.x][dest.y] + 2 * rl_dist(dest, Tx, Ty);
+                  dest_node.parent = cur;
+                  dest_node.gscore = gcost();
+                  dest_node.score = dest_node.gscore + 2 * rl_dist(dest, Tx, Ty);
+                  scratch.open(dest, dest_node);
                   break;
               case ASL_OPEN: // It's open, but make it our child
-                  if (int newg = gcost(); newg < gscore[dest.x][dest.y]) {
-                      gscore[dest.x][dest.y] = newg;
-                      parent[dest.x][dest.y] = open[index];
-                      score[dest.x][dest.y] = gscore[dest.x][dest.y] + 2 * rl_dist(dest, Tx, Ty);
+                  if (int newg = gcost(); newg < dest_node.gscore) {
+                      dest_node.gscore = newg;
+                      dest_node.parent = cur;
+                      dest_node.score = dest_node.gscore + 2 * rl_dist(dest, Tx, Ty);
+                      scratch.push(dest, dest_node);
                   }
                   break;
               }
@@ -2340,23 +2583,19 @@ std::vector<point> map::route(int Fx, int Fy, int Tx, int Ty, bool bash) const
       }
   }
 
-  list[open[index].x][open[index].y] = ASL_CLOSED;
-  open.erase(open.begin() + index);
- } while (!done && !open.empty());
+  scratch.close(cur_node);
+ } while (!done && !scratch.empty());
 
- std::vector<point> tmp;
  std::vector<point> ret;
  if (done) {
-  point cur(Tx, Ty);
-  while (cur.x != Fx || cur.y != Fy) {
-   tmp.push_back(cur);
-   assert(1 == rl_dist(cur, parent[cur.x][cur.y]));
-   cur = parent[cur.x][cur.y];
-  }
-  while (!tmp.empty()) {
-      ret.push_back(tmp.back());
-      tmp.pop_back();
+  point cur(T);
+  while (cur != F) {
+   ret.push_back(cur);
+   const point prev = scratch[cur].parent;
+   assert(1 == rl_dist(cur, prev));
+   cur = prev;
   }
+  std::reverse(ret.begin(), ret.end());
  }
  return ret;
 }
@@ -2511,6 +2750,8 @@ bool map::loadn(game *g, const point& world, int gridx, int gridy)
      gridn = gridx + gridy * my_MAPSIZE;
  if (submap * const tmpsub = MAPBUFFER.lookup_submap(absx, absy, g->cur_om.pos.z)) {
   grid[gridn] = tmpsub;
+  forget_tiles(gridn);
+  tmpsub->rebuild_indexes(Badge<map>());
  } else { // It doesn't exist; we must generate it!
   map tmp_map;
 // overx, overy is where in the overmap we need to pull data from
@@ -2531,6 +2772,8 @@ bool map::loadn(const tripoint& GPS, int gridx, int gridy)
     const int gridn = gridx + gridy * my_MAPSIZE;
     if (submap* const tmpsub = MAPBUFFER.lookup_submap(GPS.x+gridx, GPS.y + gridy, GPS.z)) {
         grid[gridn] = tmpsub;
+        forget_tiles(gridn);
+        tmpsub->rebuild_indexes(Badge<map>());
     } else { // It doesn't exist; we must generate it!
         map tmp_map;
         // overx, overy is where in the overmap we need to pull data from
@@ -2549,6 +2792,7 @@ bool map::loadn(const tripoint& GPS, int gridx, int gridy)
 void map::copy_grid(int to, int from)
 {
  grid[to] = grid[from];
+ forget_tiles(to);
 }
 
 void submap::exec_spawns(const Badge<map>& auth)
@@ -60,6 +60,7 @@ class map
  void load(const OM_loc<1>& GPS);
  void load(const OM_loc<2>& GPS) { load(OM_loc<1>(GPS.first, 2 * GPS.second)); }
  void shift(game *g, const point& world, const point& delta);
+ const std::vector<submap*>& loaded_submaps() const { return grid; }	// must stay resident in MAPBUFFER
 
  void spawn_monsters(const Badge<game>& auth);
  void post_init(const Badge<defense_game>& auth);
@@ -81,6 +82,19 @@ class map
  int move_cost(const reality_bubble_loc& pos) const;
  bool trans(const point& pt) const; // Transparent?
  bool trans(const reality_bubble_loc& pos) const;
+ // Flat per-submap summary of the terrain answers to move_cost, trans and has_flag(bashable, ...).
+ // A slice is rebuilt on demand when its submap is replaced (map::shift), its terrain is written (submap::touch),
+ // or a vehicle based in it or next to it moves; tiles a vehicle may cover are flagged and answered by the full vehicle check.
+ struct tile_summary {
+	 enum {
+		 TILE_TRANSPARENT = 1,	// terrain; fields change too often to summarize
+		 TILE_BASHABLE = 2,	// terrain
+		 TILE_VEHICLE = 4	// some vehicle part may be here; ignore the other bits
+	 };
+	 unsigned char move_cost;	// terrain
+	 unsigned char flags;
+ };
+ const tile_summary& tile(const reality_bubble_loc& pos) const;
  std::optional<int> _BresenhamLine(int Fx, int Fy, int Tx, int Ty, int range, std::function<bool(reality_bubble_loc)> test) const;
  // (Fx, Fy) sees (Tx, Ty), within a range of (range)?
  // tc indicates the Bresenham line used to connect the two points, and may
@@ -89,6 +103,27 @@ class map
  std::optional<int> sees(const point& F, int Tx, int Ty, int range) const { return sees(F.x, F.y, Tx, Ty, range); };
  std::optional<int> sees(const point& F, const point& T, int range) const { return sees(F.x, F.y, T.x, T.y, range); };
  std::optional<int> sees(int Fx, int Fy, const point& T, int range) const { return sees(Fx, Fy, T.x, T.y, range); };
+ // Field of view memo: while a fov_scope for viewer F is alive, sees(F, ...) answers from a per-tile table filled
+ // on first query, so drawing a frame runs each Bresenham search at most once.  The caller guarantees nothing
+ // affecting transparency changes during the scope (e.g., one frame of game::draw).
+ class fov_scope {
+     const map& m;
+     bool owner;
+ public:
+     fov_scope(const map& m, const point& viewer);
+     fov_scope(const fov_scope& src) = delete;
+     fov_scope(fov_scope&& src) = delete;
+     ~fov_scope();
+     fov_scope& operator=(const fov_scope& src) = delete;
+     fov_scope& operator=(fov_scope&& src) = delete;
+ };
+ struct fov_stats_t {
+     unsigned long long scopes;	// frames memoized
+     unsigned long long hits;
+     unsigned long long misses;	// Bresenham searches actually run
+     unsigned long long nanoseconds;	// spent in those searches
+ };
+ static fov_stats_t fov_stats;
  // clear_path is the same idea, but uses cost_min <= move_cost <= cost_max
  std::optional<int> clear_path(int Fx, int Fy, int Tx, int Ty, int range, int cost_min, int cost_max) const;
 // route() generates an A* best path; if bash is true, we can bash through doors
@@ -105,6 +140,7 @@ class map
  std::optional<std::pair<vehicle*, int>> _veh_at(int x, int y) { return _veh_at(point(x, y)); }
  std::optional<std::pair<const vehicle*, int>> veh_at(const reality_bubble_loc& src) const;
  std::optional<std::pair<vehicle*, int>> veh_at(const reality_bubble_loc& src);
+ std::optional<reality_bubble_loc> veh_indexed(const GPS_loc& loc) const;	// in bubble, and veh_at there sees every vehicle that could reach it
 
  vehicle* veh_near(const point& pt);
  std::optional<std::vector<std::pair<point, vehicle*> > > all_veh_near(const point& pt);
@@ -117,32 +153,34 @@ class map
 // If test is true, function only checks for submap change, no displacement
 // WARNING: not checking collisions!
  bool displace_vehicle(std::shared_ptr<vehicle> veh, const point& delta, bool test=false);
+ void vehicles_moved(const GPS_loc& origin);	// a vehicle based at origin changed its footprint
+ void remove_vehicle(vehicle& veh);	// from its chunk, and from every tile slice that may hold it
  void vehmove(game* g);          // Vehicle movement
 // move water under wheels. true if moved
  bool displace_water(const point& pt);
 
 // Terrain
- ter_id& ter(int x, int y); // Terrain at coord (x, y); {x|y}=(0, SEE{X|Y}*3]
- ter_id& ter(const point& pt) { return ter(pt.x, pt.y); }
- ter_id& ter(const reality_bubble_loc& src);
- ter_id ter(const reality_bubble_loc& src) const { return const_cast<map*>(this)->ter(src); }
- ter_id ter(int x, int y) const { return const_cast<map*>(this)->ter(x, y); }	// \todo specialize this properly
- ter_id ter(const point& pt) const { return const_cast<map*>(this)->ter(pt.x, pt.y); }
+ ter_ref ter(int x, int y); // Terrain at coord (x, y); {x|y}=(0, SEE{X|Y}*3]
+ ter_ref ter(const point& pt) { return ter(pt.x, pt.y); }
+ ter_ref ter(const reality_bubble_loc& src);
+ ter_id ter(const reality_bubble_loc& src) const;
+ ter_id ter(int x, int y) const;
+ ter_id ter(const point& pt) const { return ter(pt.x, pt.y); }
 
  template<ter_id src, ter_id dest> void rewrite(int x, int y) {
 	 static_assert(src!=dest);
-	 auto& t = ter(x,y);
+	 auto t = ter(x, y);
 	 if (src == t) t = dest;
  }
 
  template<ter_id src, ter_id dest> void rewrite_inv(int x, int y) {
 	 static_assert(src != dest);
-	 auto& t = ter(x, y);
+	 auto t = ter(x, y);
 	 if (src != t) t = dest;
  }
 
  template<ter_id src> void rewrite(int x, int y, ter_id dest) {
-	 auto& t = ter(x, y);
+	 auto t = ter(x, y);
 	 if (src == t) t = dest;
  }
 
@@ -153,13 +191,13 @@ class map
 	 static_assert(src != src2);
 	 static_assert(src != src3);
 	 static_assert(src2 != src3);
-	 auto& t = ter(x, y);
+	 auto t = ter(x, y);
 	 if (src == t || src2 == t || src3 == t) t = dest;
  }
 
  template<ter_id src, ter_id dest> bool rewrite_test(int x, int y) {
 	 static_assert(src != dest);
-	 auto& t = ter(x, y);
+	 auto t = ter(x, y);
 	 bool ret = (src == t);
 	 if (ret) t = dest;
 	 return ret;
@@ -167,7 +205,7 @@ class map
 
  template<ter_id src, ter_id dest> bool rewrite_test(const point& pt) {
 	 static_assert(src != dest);
-	 auto& t = ter(pt);
+	 auto t = ter(pt);
 	 bool ret = (src == t);
 	 if (ret) t = dest;
 	 return ret;
@@ -177,7 +215,7 @@ class map
 	 static_assert(src != dest);
 	 static_assert(src2 != dest);
 	 static_assert(src != src2);
-	 auto& t = ter(x,y);
+	 auto t = ter(x, y);
 	 bool ret = (src == t || src2 == t);
 	 if (ret) t = dest;
 	 return ret;
@@ -259,13 +297,18 @@ class map
  }
 
  template<class...Args>
- const field& field_at(Args...params) const { return const_cast<map*>(this)->field_at(params...); }
+ const field& field_at(Args...params) const {
+	 if (const auto pos = to(params...)) return field_at(*pos);
+	 return (cataclysm::discard<field>::x = field());
+ }
 
  bool add_field(game *g, int x, int y, field_id t, unsigned char density, unsigned int age=0);
  bool add_field(game *g, const point& pt, field_id t, unsigned char density, unsigned int age = 0) { return add_field(g, pt.x, pt.y, t, density, age); };
 
  template<class...Args>
  void remove_field(Args...params) { if (const auto pos = to(params...)) remove_field(*pos); }
+ template<class...Args>
+ void replace_field(field&& src, Args...params) { if (const auto pos = to(params...)) replace_field(*pos, std::move(src)); }
 
  bool process_fields();				// See field.cpp
  void step_in_field(game* g, player& u);		// See field.cpp	// V 0.2.5+ break hard-coding to player g->u
@@ -317,8 +360,36 @@ protected:
  std::vector<submap*> grid;
 
 private:
+	struct fov_memo {
+		struct cell {
+			unsigned int los_stamp;
+			unsigned int trans_stamp;
+			int tc;	// INT_MIN: no line of sight
+			bool trans;
+		};
+		bool active;
+		point origin;
+		unsigned int generation;
+		std::vector<cell> cells;	// indexed by reality_bubble_loc; allocated on first use
+	};
+	mutable fov_memo _fov = {};
+
+	struct alignas(64) tile_slice {
+		tile_summary tiles[SEEX][SEEY];
+		vehicle* veh[SEEX][SEEY];	// valid where tiles has TILE_VEHICLE
+		int part[SEEX][SEEY];
+		const submap* source;
+		unsigned long long revision;	// submap::tile_revision() of source when built
+		unsigned long long vehicles;	// submap::vehicle_tile_revision() of source when built
+	};
+	mutable std::vector<tile_slice> _tiles;	// indexed by grid index; allocated on first use
+	void build_tiles(int n) const;
+	void forget_tiles(int n);	// grid[n] was replaced; its slice and those next to it see other vehicles now
+
 	field& field_at(const reality_bubble_loc& src);
+	const field& field_at(const reality_bubble_loc& src) const;
 	void remove_field(const reality_bubble_loc& src);
+	void replace_field(const reality_bubble_loc& dest, field&& src);
 
 	std::vector<item>& i_at(const reality_bubble_loc& pos);
 
@@ -3,71 +3,327 @@
 #include "recent_msg.h"
 #include "saveload.h"
 #include "ios_file.h"
+#include "binary_io.hpp"
+#include "savefile.hpp"
+#include <algorithm>
 #include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <unordered_set>
 
 mapbuffer MAPBUFFER;
 
+static const char page_magic[4] = { 'C', 'S', 'M', 'B' };	// binary page; otherwise the text format of save/maps.txt
+
 mapbuffer::~mapbuffer()
 {
- for (auto x : submaps) delete x.second;
+ for (auto& s : shards) {
+  for (auto x : s.second.submaps) delete x.second;
+ }
+}
+
+size_t mapbuffer::tripoint_hash::operator()(const tripoint& src) const
+{
+ size_t ret = (size_t)src.x * 73856093U;
+ ret ^= (size_t)src.y * 19349663U;
+ ret ^= (size_t)src.z * 83492791U;
+ return ret;
+}
+
+tripoint mapbuffer::shard_key(const tripoint& sm)
+{  // floor division: submap coordinates go negative
+ static constexpr const int span = 2 * OMAP;
+ return tripoint((0 <= sm.x) ? sm.x / span : (sm.x + 1) / span - 1, (0 <= sm.y) ? sm.y / span : (sm.y + 1) / span - 1, sm.z);
+}
+
+std::string mapbuffer::page_name(const tripoint& key)
+{
+ std::ostringstream ret;
+ ret << "save/m." << key.x << "." << key.y << "." << key.z;
+ return ret.str();
+}
+
+mapbuffer::shard* mapbuffer::find_shard(const tripoint& key)
+{
+ if (_last && key == _last_key) return _last;
+ auto it = shards.find(key);
+ if (shards.end() == it) {
+  if (absent.count(key) || !page_in(key)) return nullptr;
+  it = shards.find(key);
+ }
+ _last_key = key;
+ return _last = &it->second;
 }
 
 bool mapbuffer::add_submap(int x, int y, int z, submap *sm)
 {
  tripoint p(x, y, z);
- if (submaps.count(p) != 0) return false;
+ const tripoint key = shard_key(p);
+ shard* dest = find_shard(key);	// pages in whatever is already on disk for this overmap
+ if (!dest) {
+  dest = &shards[key];
+  dest->last_touched = int(messages.turn);
+  absent.erase(key);
+ }
+ if (dest->submaps.count(p) != 0) return false;
 
  sm->set(p, int(messages.turn), Badge<mapbuffer>());
- submaps[p] = sm;
+ dest->submaps[p] = sm;
+ dest->dirty = true;
+ _size++;
  return true;
 }
 
 submap* mapbuffer::lookup_submap(const tripoint& src)
 {   // this should not trigger map generation; would be ok to check hard drive for pre-existing chunk
-    return (0 < submaps.count(src)) ? submaps[src] : nullptr;
+    shard* const dest = find_shard(shard_key(src));
+    if (!dest) return nullptr;
+    const auto it = dest->submaps.find(src);
+    if (dest->submaps.end() == it) return nullptr;
+    dest->last_touched = int(messages.turn);
+    dest->lent = true;	// caller may write through the pointer; settle() finds out whether it did
+    it->second->set_last_touched(dest->last_touched, Badge<mapbuffer>());
+    it->second->lent(Badge<mapbuffer>()) = true;
+    return it->second;
 }
 
-#define MAP_FILE "save/maps.txt"
+const submap* mapbuffer::peek_submap(const tripoint& src)
+{
+    shard* const dest = find_shard(shard_key(src));
+    if (!dest) return nullptr;
+    const auto it = dest->submaps.find(src);
+    return (dest->submaps.end() == it) ? nullptr : it->second;
+}
 
-void mapbuffer::save()
+std::vector<std::pair<tripoint, submap*> > mapbuffer::sorted() const
 {
- if (submaps.empty()) return;
+ std::vector<std::pair<tripoint, submap*> > ret;
+ ret.reserve(_size);
+ for (const auto& s : shards) {
+  for (const auto& x : s.second.submaps) ret.push_back(x);
+ }
+ std::sort(ret.begin(), ret.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+ return ret;
+}
 
- DECLARE_AND_ACID_OPEN(std::ofstream, fout, MAP_FILE, return;)
+void mapbuffer::settle(shard& src)
+{
+ if (!src.lent) return;
+ src.lent = false;
+ for (const auto& it : src.submaps) {
+  bool& lent = it.second->lent(Badge<mapbuffer>());
+  if (!lent) continue;
+  lent = false;
+  std::ostringstream encoded;
+  it.second->write(encoded);
+  std::string& cache = it.second->page_cache(Badge<mapbuffer>());
+  if (cache == encoded.str()) continue;
+  cache = encoded.str();
+  src.dirty = true;
+ }
+}
 
- fout << submaps.size() << std::endl;
- int percent = 0;
+bool mapbuffer::write_page(const tripoint& key, const shard& src, const std::unordered_set<const submap*>& live, save_stats& stats)
+{
+ std::vector<std::pair<tripoint, submap*> > ordered(src.submaps.begin(), src.submaps.end());
+ std::sort(ordered.begin(), ordered.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
 
- for(const auto& it : submaps) {
-  percent++;
-  if (percent % 100 == 0)
-   popup_nowait("Please wait as the map saves [%s%d/%d]",
-                (percent < 100 ?  percent < 10 ? "  " : " " : ""), percent,
-                submaps.size());
-  fout << it.first << std::endl;
-  fout << *it.second;
+ std::ostringstream fout;
+ fout.write(page_magic, sizeof(page_magic));
+ submap::id_tables::write(fout);
+ cataclysm::binary::write_uint(fout, ordered.size());
+ for (const auto& it : ordered) {
+  cataclysm::binary::write_int(fout, it.first.x);
+  cataclysm::binary::write_int(fout, it.first.y);
+  cataclysm::binary::write_int(fout, it.first.z);
+  std::string& cache = it.second->page_cache(Badge<mapbuffer>());
+  if (live.count(it.second)) {
+   cache.clear();
+   it.second->write(fout);
+   stats.encoded++;
+  } else {
+   if (cache.empty()) {
+    std::ostringstream encoded;
+    it.second->write(encoded);
+    cache = encoded.str();
+    stats.encoded++;
+   } else stats.reused++;
+   fout.write(cache.data(), cache.size());
+  }
+ }
+ if (!fout) {
+  debugmsg("Failed to encode %s.", page_name(key).c_str());
+  return false;
  }
- // Close the file; that's all we need.
- OFSTREAM_ACID_CLOSE(fout, MAP_FILE)
+ // the snapshot is taken; the hard drive is the save thread's problem
+ std::string bytes = fout.str();
+ stats.bytes += bytes.size();
+ savefile::get().write_binary(page_name(key), std::move(bytes));
+ stats.pages++;
+ return true;
+}
 
+bool mapbuffer::page_out(const tripoint& key)
+{
+ auto it = shards.find(key);
+ if (shards.end() == it) return false;
+ settle(it->second);
+ save_stats discard = {};
+ if (it->second.dirty && !write_page(key, it->second, std::unordered_set<const submap*>(), discard)) return false;
+
+ for (const auto& x : it->second.submaps) delete x.second;
+ _size -= it->second.submaps.size();
+ if (_last == &it->second) _last = nullptr;
+ shards.erase(it);
+ paged_out.insert(key);
+ return true;
+}
+
+bool mapbuffer::page_in(const tripoint& key)
+{
+ try {
+  return read_page(key);
+ } catch (const std::exception& e) {
+  // a damaged page is lost, not fatal: drop what was read of it, set it aside, and let the region generate afresh
+  const auto src = page_name(key);
+  debuglog("%s: %s; moved to %s.bad", src.c_str(), e.what(), src.c_str());
+  unlink((src + ".bad").c_str());
+  rename(src.c_str(), (src + ".bad").c_str());
+  auto it = shards.find(key);
+  if (shards.end() != it) {
+   for (const auto& x : it->second.submaps) delete x.second;
+   _size -= it->second.submaps.size();
+   shards.erase(it);
+  }
+  absent.insert(key);
+  return false;
+ }
+}
+
+bool mapbuffer::read_page(const tripoint& key)
+{
+ std::string bytes;
+ if (!savefile::get().read(page_name(key), bytes, true)) {	// may have been paged out moments ago
+  absent.insert(key);
+  return false;
+ }
+ std::istringstream fin(bytes);
+
+ shard& dest = shards[key];
+ dest.last_touched = int(messages.turn);
+ char magic[sizeof(page_magic)];
+ if (fin.read(magic, sizeof(magic)) && std::equal(magic, magic + sizeof(magic), page_magic)) {
+  const auto ids = submap::id_tables::read(fin);
+  auto num_submaps = cataclysm::binary::read_uint(fin);
+  while (0 < num_submaps--) {
+   tripoint gps;
+   gps.x = int(cataclysm::binary::read_int(fin));
+   gps.y = int(cataclysm::binary::read_int(fin));
+   gps.z = int(cataclysm::binary::read_int(fin));
+   const auto start = fin.tellg();
+   submap* const sm = new submap(fin, gps, ids, !paged_out.count(key));
+   if (!dest.submaps.insert(std::pair(gps, sm)).second) delete sm;
+   else {
+    sm->page_cache(Badge<mapbuffer>()).assign(bytes, start, fin.tellg() - start);	// so a read-only visit does not rewrite the page
+    _size++;
+   }
+  }
+  return true;
+ }
+
+ // text page, as written before the binary format
+ fin.clear();
+ fin.seekg(0);
+ int num_submaps;
+ fin >> num_submaps;
+ while (0 < num_submaps--) {
+  tripoint gps;
+  fin >> gps;
+  if (!fin) break;
+  submap* const sm = new submap(fin, gps);
+  if (!dest.submaps.insert(std::pair(gps, sm)).second) delete sm;
+  else _size++;
+ }
+ return true;
+}
+
+size_t mapbuffer::evict(const std::vector<submap*>& pinned)
+{
+ if (resident_budget >= _size) return 0;
+
+ const std::unordered_set<const submap*> keep(pinned.begin(), pinned.end());
+ std::vector<std::pair<int, tripoint> > candidates;
+ for (const auto& s : shards) {
+  if (std::any_of(s.second.submaps.begin(), s.second.submaps.end(), [&](const auto& x) { return keep.count(x.second); })) continue;
+  candidates.push_back(std::pair(s.second.last_touched, s.first));
+ }
+ std::sort(candidates.begin(), candidates.end());	// least recently touched first
+
+ // evict down to 3/4 of budget, so we are not back here next autosave
+ const size_t target = resident_budget / 4 * 3;
+ const size_t before = _size;
+ for (const auto& x : candidates) {
+  if (target >= _size) break;
+  page_out(x.second);
+ }
+ return before - _size;
+}
+
+#define MAP_FILE "save/maps.txt"
+
+void mapbuffer::save(const std::vector<submap*>& pinned)
+{
+ _last_save = save_stats{};
+ const std::unordered_set<const submap*> live(pinned.begin(), pinned.end());
+ std::vector<std::pair<tripoint, shard*> > pending;
+ for (auto& s : shards) {
+  settle(s.second);
+  if (!s.second.dirty && std::any_of(s.second.submaps.begin(), s.second.submaps.end(), [&](const auto& x) { return live.count(x.second); })) s.second.dirty = true;
+  if (s.second.dirty) pending.push_back(std::pair(s.first, &s.second));
+ }
+ if (pending.empty()) return;
+ std::sort(pending.begin(), pending.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+ size_t percent = 0;
+ bool ok = true;
+ for (const auto& it : pending) {
+  if (++percent % 10 == 0)
+   popup_nowait("Please wait as the map saves [%d/%d]", (int)percent, (int)pending.size());
+  if (write_page(it.first, *it.second, live, _last_save)) {
+   // live submaps keep changing after this; their region must be written again, even if they are no longer live by then
+   it.second->dirty = std::any_of(it.second->submaps.begin(), it.second->submaps.end(), [&](const auto& x) { return live.count(x.second); });
+  } else ok = false;
+ }
+ // everything imported from a legacy monolithic save is now in pages, once the writer gets to them
+ if (ok && _legacy) {
+  savefile::get().remove(MAP_FILE);	// queued behind the pages
+  _legacy = false;
+ }
 }
 
 void mapbuffer::load()
 {
  DECLARE_AND_OPEN_SILENT(std::ifstream, fin, MAP_FILE, return;)
+ _legacy = true;
 
  int num_submaps;
  fin >> num_submaps;
 
  while (!fin.eof()) {
-  int percent = submaps.size();
+  int percent = _size;
   if (percent % 100 == 0)
    popup_nowait("Please wait as the map loads [%s%d/%d]",
                 (percent < 100 ?  percent < 10 ? "  " : " " : ""), percent,
                 num_submaps);
   tripoint gps;
   fin >> gps;
-  submaps[gps] = new submap(fin, gps);
+  shard& dest = shards[shard_key(gps)];
+  auto& sm = dest.submaps[gps];
+  if (!sm) _size++;
+  else delete sm;
+  sm = new submap(fin, gps);
+  dest.last_touched = std::max(dest.last_touched, sm->last_touched());
+  dest.dirty = true;	// not in a page yet
  }
  fin.close();
 }
@@ -4,30 +4,77 @@
 #include "enums.h"
 #include "submap.h"
 
-#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 class mapbuffer // \todo natural singleton, but likely needs pre-requisites loaded before it is loaded for that
 {
  public:
-  mapbuffer() = default;
+  static constexpr const size_t resident_budget = 8192;	// submaps kept in memory before untouched overmap regions are paged out
+
+  mapbuffer() : _size(0), _last(nullptr), _legacy(false), _last_save{} {}
   mapbuffer(const mapbuffer& src) = delete;
   mapbuffer(mapbuffer&& src) = default;
   ~mapbuffer();	// raw pointers involved so cannot default-destruct or default-copy
   mapbuffer& operator=(const mapbuffer& src) = delete;
   mapbuffer& operator=(mapbuffer&& src) = default;
 
-  void load();
-  void save();
+  struct save_stats {
+	  size_t pages;	// written
+	  size_t encoded;	// submaps encoded afresh
+	  size_t reused;	// submaps written from their encoding as last saved
+	  size_t bytes;
+  };
+
+  void load();	// only imports a legacy save/maps.txt; pages load on demand
+  void save(const std::vector<submap*>& pinned);	// writes regions touched since they were last written, and those holding pinned
+  const save_stats& last_save() const { return _last_save; }
 
   // anything that calls these will want the full submap.h header
   bool add_submap(int x, int y, int z, submap *sm);
   submap* lookup_submap(const tripoint& src);
   submap* lookup_submap(int x, int y, int z) { return lookup_submap(tripoint(x, y, z)); }
+  const submap* peek_submap(const tripoint& src);	// read-only: not a touch, and not lent out
 
-  std::size_t size() const { return submaps.size(); }
+  std::size_t size() const { return _size; }	// resident submaps only
+  std::vector<std::pair<tripoint, submap*> > sorted() const;	// resident submaps, in coordinate order
+  // pages out least recently touched overmap regions until under budget; pinned submaps (e.g. the reality bubble) stay
+  size_t evict(const std::vector<submap*>& pinned);
 
  private:
-  std::map<tripoint, submap*> submaps;	// candidate for absolute coordinates: tripoint (submap index),point (legal values 0..SEE-1 for both x,y)
+  struct tripoint_hash {
+	  size_t operator()(const tripoint& src) const;
+  };
+  using submaps_t = std::unordered_map<tripoint, submap*, tripoint_hash>;
+  struct shard {	// all submaps of one overmap; paged to disk as a unit
+	  submaps_t submaps;
+	  int last_touched = 0;
+	  bool dirty = false;	// changed since its page was last written
+	  bool lent = false;	// submaps handed out since last settled
+  };
+
+  std::unordered_map<tripoint, shard, tripoint_hash> shards;	// keyed by overmap coordinate
+  std::unordered_set<tripoint, tripoint_hash> absent;	// overmaps known to have no page on disk
+  std::unordered_set<tripoint, tripoint_hash> paged_out;	// by this session: their pages are already as of now
+  std::size_t _size;
+  // lookups cluster heavily; remember the last shard
+  tripoint _last_key;
+  shard* _last;
+  bool _legacy;	// imported save/maps.txt; remove it once every page is written
+  save_stats _last_save;
+
+  static tripoint shard_key(const tripoint& sm);
+  static std::string page_name(const tripoint& key);
+  shard* find_shard(const tripoint& key);
+  bool page_in(const tripoint& key);	// a damaged page is logged and treated as absent
+  bool read_page(const tripoint& key);	// throws std::runtime_error on a damaged page
+  bool page_out(const tripoint& key);
+  static void settle(shard& src);	// re-encodes the submaps handed out; dirty if any changed
+  // submaps in live are encoded afresh, and their encoding not kept: they are still changing
+  static bool write_page(const tripoint& key, const shard& src, const std::unordered_set<const submap*>& live, save_stats& stats);
 };
 
 extern mapbuffer MAPBUFFER;
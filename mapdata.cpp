@@ -1,4 +1,5 @@
 #include "mapdata.h"
+#include "GPS_loc.hpp"
 #include "json.h"
 
 std::map<ter_id, std::string> ter_t::tiles;
@@ -347,7 +348,7 @@ mfb(transparent) }
 };
 
 // from codegen.py3
-static const char* JSON_transcode[num_terrain_types] = {
+static constexpr const char* JSON_transcode[num_terrain_types] = {
 	"t_null",
 	"t_hole",
 	"t_dirt",
@@ -485,7 +486,8 @@ static const char* JSON_transcode[num_terrain_types] = {
 
 DEFINE_JSON_ENUM_SUPPORT_TYPICAL(ter_id, JSON_transcode)
 
-bool close_door(ter_id& t)
+#ifndef SOCRATES_DAIMON
+bool close_door(ter_ref t)
 {
 	switch (t) {
 	case t_door_o:
@@ -501,7 +503,7 @@ bool close_door(ter_id& t)
 	}
 }
 
-bool open_door(ter_id& t, bool inside)
+bool open_door(ter_ref t, bool inside)
 {
 	switch (t) {
 	case t_door_c:
@@ -523,6 +525,7 @@ bool open_door(ter_id& t, bool inside)
 	default: return false;
 	}
 }
+#endif
 
 static ter_id rotate_90(ter_id t)
 {
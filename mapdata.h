@@ -109,8 +109,9 @@ template<int lb, int ub> constexpr bool any(ter_id src) {
     return lb == src || ub == src;
 }
 
-bool close_door(ter_id& t);
-bool open_door(ter_id& t, bool inside);
+class ter_ref;
+bool close_door(ter_ref t);
+bool open_door(ter_ref t, bool inside);
 ter_id rotate_(ter_id t, int x90degrees); // have to avoid name collision w/map::rotate
 
 struct ter_t {
@@ -193,6 +194,8 @@ struct field {
   return (type == fd_null || type == fd_blood || type == fd_bile || type == fd_slime);
  }
 
+ // process_fields skips "newborn" (age 0) fields, and nothing else ages them except rain on fire
+ bool is_idle() const { return fd_null == type || (0 == age && fd_fire != type); }
  bool is_dangerous() const { return list[type].dangerous[density - 1]; }
  std::string name() const { return list[type].name[density - 1]; }
 };
@@ -108,6 +108,7 @@ static map_extra random_map_extra(const map_extras& embellishments)
 	int pick = 0;
 	// Set pick to the total of all the chances for map extras
 	for (const auto it : embellishments.chances) pick += it;
+	if (0 >= pick) return mx_null;	// no extras for this terrain (chance 0 passes one_in)
 	// Set pick to a number between 0 and the total
 	pick = rng(0, pick - 1);
 	int choice = -1;
@@ -116,7 +117,7 @@ static map_extra random_map_extra(const map_extras& embellishments)
 }
 
 submap::submap(int t0)
-: active_item_count(0), field_count(0), turn_last_touched(t0)
+: turn_last_touched(t0), page_lent(false)
 {
 	memset(ter, 0, sizeof(ter));
 	memset(trp, 0, sizeof(trp));
@@ -257,7 +258,7 @@ void map::generate(game *g, overmap *om, int x, int y)
 // policy: make the caller responsible for the correct y range (historically non-strict upper bound is y0+5)
 void map::apply_temple_switch(ter_id trigger, int y0, int x, int y)
 {
-	auto& t = ter(x, y);
+	auto t = ter(x, y);
 	switch (trigger) {
 	case t_switch_rg:
 		if (t_rock_red == t) t = t_floor_red;
@@ -499,7 +500,7 @@ void map::draw_map(oter_id terrain_type, oter_id t_north, oter_id t_east,
    x = SEEX / 2 + rng(0, SEEX), y = SEEY / 2 + rng(0, SEEY);
    for (int i = 0; i < 20; i++) {
     if (x >= 0 && x < SEEX * 2 && y >= 0 && y < SEEY * 2) {
-	 auto& t = ter(x, y);
+	 auto t = ter(x, y);
      if (t_water_sh == t) t = t_water_dp;
      else if (t_dirt == t || t_underbrush == t) t = t_water_sh;
     } else break;
@@ -510,22 +511,22 @@ void map::draw_map(oter_id terrain_type, oter_id t_north, oter_id t_east,
     if (y < 0 || y >= SEEY * 2) y = SEEY / 2 + rng(0, SEEY);
     for (int j = 0; j < n_fac; j++) {
      int wx = rng(0, SEEX * 2 -1), wy = rng(0, SEEY - 1);
-	 auto& t = ter(wx, wy);
+	 auto t = ter(wx, wy);
 	 if (t_dirt == t || t_underbrush == t) t = t_water_sh;
 	}
     for (int j = 0; j < e_fac; j++) {
      int wx = rng(SEEX, SEEX * 2 - 1), wy = rng(0, SEEY * 2 - 1);
-	 auto& t = ter(wx, wy);
+	 auto t = ter(wx, wy);
 	 if (t_dirt == t || t_underbrush == t) t = t_water_sh;
 	}
     for (int j = 0; j < s_fac; j++) {
      int wx = rng(0, SEEX * 2 - 1), wy = rng(SEEY, SEEY * 2 - 1);
-	 auto& t = ter(wx, wy);
+	 auto t = ter(wx, wy);
 	 if (t_dirt == t || t_underbrush == t) t = t_water_sh;
 	}
     for (int j = 0; j < w_fac; j++) {
      int wx = rng(0, SEEX - 1), wy = rng(0, SEEY * 2 - 1);
-	 auto& t = ter(wx, wy);
+	 auto t = ter(wx, wy);
 	 if (t_dirt == t ||  t_underbrush == t) t = t_water_sh;
     }
    }
@@ -534,7 +535,7 @@ void map::draw_map(oter_id terrain_type, oter_id t_north, oter_id t_east,
     x = rng(0, SEEX * 2 - 1);
     y = rng(0, SEEY * 2 - 1);
     add_trap(x, y, tr_sinkhole);
-	auto& t = ter(x, y);
+	auto t = ter(x, y);
 	if (t_water_sh != t) t = t_dirt;
    }
   }
@@ -542,7 +543,7 @@ void map::draw_map(oter_id terrain_type, oter_id t_north, oter_id t_east,
   if (one_in(100)) { // One in 100 forests has a spider living in it :o
    for (int i = 0; i < SEEX * 2; i++) {
     for (int j = 0; j < SEEX * 2; j++) {
-	 auto& t = ter(i, j);
+	 auto t = ter(i, j);
      if ((t_dirt == t || t_underbrush == t) && !one_in(3))
       field_at(i, j) = field(fd_web, rng(1, 3));
     }
@@ -1220,7 +1221,7 @@ void map::draw_map(oter_id terrain_type, oter_id t_north, oter_id t_east,
   if (one_in(100)) { // Houses have a 1 in 100 chance of wasps!
    for (int i = 0; i < SEEX * 2; i++) {
     for (int j = 0; j < SEEY * 2; j++) {
-	 auto& t = ter(i, j);
+	 auto t = ter(i, j);
      if (t_door_c == t || t_door_locked == t) t = t_door_frame;
      if (t_window == t && !one_in(3)) t = t_window_frame;
      if ((t_wall_h == t || t_wall_v == t) && one_in(8)) t = t_paper;
@@ -2100,7 +2101,7 @@ void map::draw_map(oter_id terrain_type, oter_id t_north, oter_id t_east,
   } else if (tw != 0 || rw != 0 || lw != 0 || bw != 0) {	// Sewers!
    for (int i = 0; i < SEEX * 2; i++) {
     for (int j = 0; j < SEEY * 2; j++) {
-	 auto& t = ter(i, j);
+	 auto t = ter(i, j);
      t = t_floor;
      if (((i < lw || i > SEEX * 2 - 1 - rw) && j > SEEY - 3 && j < SEEY + 2) ||
          ((j < tw || j > SEEY * 2 - 1 - bw) && i > SEEX - 3 && i < SEEX + 2))
@@ -2857,7 +2858,7 @@ void map::draw_map(oter_id terrain_type, oter_id t_north, oter_id t_east,
 // Now go backwards through path (start to finish), toggling any tiles that need
      bool toggle_red = false, toggle_green = false, toggle_blue = false;
      for (int i = path.size() - 1; i >= 0; i--) {
-	  auto& t = ter(path[i]);
+	  auto t = ter(path[i]);
       if (t_floor_red == t) {
        toggle_green = !toggle_green;
        if (toggle_red) t = t_rock_red;
@@ -5812,7 +5813,7 @@ void map::place_items(items_location loc, int chance, int x1, int y1,
    px = rng(x1, x2);
    py = rng(y1, y2);
 // Only place on valid terrain
-   const auto terrain = ter(px, py);
+   const ter_id terrain = ter(px, py);
    if (!ongrass && (t_dirt == terrain || t_grass == terrain)) continue;
    const auto& t_data = ter_t::list[terrain];
    if (t_data.movecost == 0 && !(t_data.flags & mfb(container))) continue;
@@ -6000,7 +6001,7 @@ void house_room(map *m, room_type type, int x1, int y1, int x2, int y2)
 {
  for (int i = x1; i <= x2; i++) {
   for (int j = y1; j <= y2; j++) {
-   auto& t = m->ter(i, j);
+   auto t = m->ter(i, j);
    if (t_grass == t || t_dirt == t || t_floor == t) {
     if (j == y1 || j == y2) {
      t = t_wall_h;
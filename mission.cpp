@@ -26,7 +26,7 @@ void mission::global_toJSON(cataclysm::JSON& dest)
 }
 
 
-static const char* JSON_transcode[] = {
+static constexpr const char* JSON_transcode[] = {
     "GET_ANTIBIOTICS",
     "GET_SOFTWARE",
     "GET_ZOMBIE_BLOOD_ANAL",
@@ -168,7 +168,7 @@ void mission_start::place_npc_software(game *g, mission *miss)
 					bool okay = false;
 					for (int x2 = x - 1; x2 <= x + 1 && !okay; x2++) {
 						for (int y2 = y - 1; y2 <= y + 1 && !okay; y2++) {
-							const auto t = compmap.ter(x2, y2);
+							const ter_id t = compmap.ter(x2, y2);
 							if (t_bed == t || t_dresser == t) {
 								okay = true;
 								valid.push_back(point(x, y));
@@ -0,0 +1,147 @@
+#include "mob_index.hpp"
+#include "monster.h"
+#include "npc.h"
+#include "ui.h"
+
+#include <algorithm>
+#include <cstdint>
+
+mob_index& mob_index::get()
+{
+	static mob_index ooao;
+	return ooao;
+}
+
+size_t mob_index::hash::operator()(const GPS_loc& src) const
+{
+	size_t ret = (size_t)(src.first.x * SEE + src.second.x) * 73856093U;
+	ret ^= (size_t)(src.first.y * SEE + src.second.y) * 19349663U;
+	ret ^= (size_t)src.first.z * 83492791U;
+	return ret;
+}
+
+static const mobile* as_mobile(const std::variant<monster*, npc*>& src)
+{
+	if (const auto _mon = std::get_if<monster*>(&src)) return *_mon;
+	return std::get<npc*>(src);
+}
+
+void mob_index::rebuild(std::vector<monster>& z, npcs_t& active_npc)
+{
+	_index.clear();
+	_index.reserve(z.size() + active_npc.size());
+	size_t i = 0;
+	for (decltype(auto) _mon : z) _index.emplace(_mon.GPSpos, entry{ &_mon, i++ });
+	i = 0;
+	for (decltype(auto) _npc : active_npc) _index.emplace(_npc->GPSpos, entry{ _npc.get(), i++ });
+	_z = z.data();
+	_z_size = z.size();
+	_npcs = active_npc.data();
+	_npcs_size = active_npc.size();
+	_valid = true;
+}
+
+void mob_index::moved(const mobile& who, const GPS_loc& origin)
+{
+	if (!_valid) return;	// next query rebuilds anyway
+	auto range = _index.equal_range(origin);
+	while (range.first != range.second) {
+		if (&who == as_mobile(range.first->second.who)) {
+			auto relocate = _index.extract(range.first);
+			relocate.key() = who.GPSpos;
+			_index.insert(std::move(relocate));
+			return;
+		}
+		++range.first;
+	}
+	// not one of ours (e.g., a monster being set up before game::spawn)
+}
+
+monster* mob_index::mon(const GPS_loc& loc) const
+{
+	monster* ret = nullptr;
+	size_t slot = SIZE_MAX;
+	auto range = _index.equal_range(loc);
+	while (range.first != range.second) {
+		const entry& x = (range.first++)->second;
+		if (const auto _mon = std::get_if<monster*>(&x.who)) {
+			if (!(*_mon)->dead && x.slot < slot) {
+				ret = *_mon;
+				slot = x.slot;
+			}
+		}
+	}
+	return ret;
+}
+
+npc* mob_index::nPC(const GPS_loc& loc) const
+{
+	npc* ret = nullptr;
+	size_t slot = SIZE_MAX;
+	auto range = _index.equal_range(loc);
+	while (range.first != range.second) {
+		const entry& x = (range.first++)->second;
+		if (const auto _npc = std::get_if<npc*>(&x.who)) {
+			if (!(*_npc)->dead && x.slot < slot) {
+				ret = *_npc;
+				slot = x.slot;
+			}
+		}
+	}
+	return ret;
+}
+
+void mob_index::in_range(const GPS_loc& origin, int range, std::vector<monster*>& mons, std::vector<npc*>& npcs) const
+{
+	std::vector<std::pair<size_t, monster*> > found_mons;
+	std::vector<std::pair<size_t, npc*> > found_npcs;
+	const auto take = [&](const entry& x) {
+		if (range < rl_dist(origin, as_mobile(x.who)->GPSpos)) return;
+		if (const auto _mon = std::get_if<monster*>(&x.who)) {
+			if (!(*_mon)->dead) found_mons.push_back(std::pair(x.slot, *_mon));
+		} else {
+			npc* const _npc = std::get<npc*>(x.who);
+			if (!_npc->dead) found_npcs.push_back(std::pair(x.slot, _npc));
+		}
+	};
+
+	const size_t span = 2 * (size_t)range + 1;
+	if (span * span < _index.size()) {	// probe each tile in range
+		point delta;
+		for (delta.x = -range; delta.x <= range; delta.x++) {
+			for (delta.y = -range; delta.y <= range; delta.y++) {
+				auto at = _index.equal_range(origin + delta);
+				while (at.first != at.second) take((at.first++)->second);
+			}
+		}
+	} else {	// cheaper to look at everyone
+		for (const auto& x : _index) take(x.second);
+	}
+
+	std::sort(found_mons.begin(), found_mons.end());
+	std::sort(found_npcs.begin(), found_npcs.end());
+	for (const auto& x : found_mons) mons.push_back(x.second);
+	for (const auto& x : found_npcs) npcs.push_back(x.second);
+}
+
+size_t mob_index::check(std::vector<monster>& z, npcs_t& active_npc) const
+{
+	if (!is_valid(z, active_npc)) return z.size() + active_npc.size();	// caller should have rebuilt us
+	size_t ret = 0;
+	// every living monster and NPC must be found where it stands, and nothing else found there first
+	for (decltype(auto) _mon : z) {
+		if (_mon.dead) continue;
+		monster* expected = nullptr;
+		for (decltype(auto) m : z) if (m.GPSpos == _mon.GPSpos && !m.dead) { expected = &m; break; }
+		if (mon(_mon.GPSpos) != expected) ret++;
+	}
+	for (decltype(auto) _npc : active_npc) {
+		if (_npc->dead) continue;
+		npc* expected = nullptr;
+		for (decltype(auto) n : active_npc) if (n->GPSpos == _npc->GPSpos && !n->dead) { expected = n.get(); break; }
+		if (nPC(_npc->GPSpos) != expected) ret++;
+	}
+	// every entry must be filed under where its mob actually is
+	for (const auto& x : _index) if (x.first != as_mobile(x.second.who)->GPSpos) ret++;
+	return ret;
+}
@@ -0,0 +1,67 @@
+#ifndef MOB_INDEX_HPP
+#define MOB_INDEX_HPP 1
+
+#include "GPS_loc.hpp"
+#include <memory>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+class mobile;
+class monster;
+class npc;
+
+// Spatial index of game::z and game::active_npc by GPS location.
+// mobile::set_screenpos and monster::screenpos_* report moves as they happen; adding or removing monsters/NPCs
+// invalidates the index, and the next query rebuilds it.  Dead entries stay indexed until removed, so lookups filter them.
+// singleton
+class mob_index
+{
+public:
+	using npcs_t = std::vector<std::shared_ptr<npc> >;
+
+private:
+	struct entry {
+		std::variant<monster*, npc*> who;
+		size_t slot;	// index into game::z or game::active_npc; lookups return the lowest, as the linear scans did
+	};
+	struct hash {
+		size_t operator()(const GPS_loc& src) const;
+	};
+
+	std::unordered_multimap<GPS_loc, entry, hash> _index;
+	// layout of the containers we were built from; a mismatch means someone bypassed invalidate()
+	const monster* _z;
+	size_t _z_size;
+	const std::shared_ptr<npc>* _npcs;
+	size_t _npcs_size;
+	bool _valid;
+
+	mob_index() : _z(nullptr), _z_size(0), _npcs(nullptr), _npcs_size(0), _valid(false) {}
+	~mob_index() = default;
+	mob_index(const mob_index& src) = delete;
+	mob_index(mob_index&& src) = delete;
+	mob_index& operator=(const mob_index& src) = delete;
+	mob_index& operator=(mob_index&& src) = delete;
+
+public:
+	static mob_index& get();
+
+	bool is_valid(const std::vector<monster>& z, const npcs_t& active_npc) const {
+		return _valid && z.data() == _z && z.size() == _z_size && active_npc.data() == _npcs && active_npc.size() == _npcs_size;
+	}
+	void invalidate() { _valid = false; }
+	void rebuild(std::vector<monster>& z, npcs_t& active_npc);
+	void moved(const mobile& who, const GPS_loc& origin);
+
+	monster* mon(const GPS_loc& loc) const;
+	npc* nPC(const GPS_loc& loc) const;
+	// living monsters and NPCs within range (range > 0), each list in container order
+	void in_range(const GPS_loc& origin, int range, std::vector<monster*>& mons, std::vector<npc*>& npcs) const;
+
+	// number of disagreements with a linear scan of z and active_npc
+	size_t check(std::vector<monster>& z, npcs_t& active_npc) const;
+	auto size() const { return _index.size(); }
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include "mobile.h"
 
 #include "game.h"
+#include "mob_index.hpp"
 #include "vehicle.h"
 #include "rng.h"
 
@@ -24,12 +25,24 @@ reality_bubble_loc mobile::bubblePos() const
 	return *ret;
 }
 
-void mobile::set_screenpos(point pt) { GPSpos = overmap::toGPS(pt); }
+void mobile::set_screenpos(point pt)
+{
+	const GPS_loc origin = GPSpos;
+	GPSpos = overmap::toGPS(pt);
+	moved_from(origin);
+}
 
 void mobile::set_screenpos(const GPS_loc& loc)
 {
+	const GPS_loc origin = GPSpos;
 	GPSpos = loc;
 	_set_screenpos();
+	moved_from(origin);
+}
+
+void mobile::moved_from(const GPS_loc& origin)
+{
+	if (origin != GPSpos) mob_index::get().moved(*this, origin);
 }
 
 void mobile::knockback_from(const GPS_loc& loc)
@@ -81,6 +81,7 @@ protected:
 
 	void set_screenpos(point pt); // could be public once synchronization with legacy point pos not needed
 	virtual void _set_screenpos() = 0;
+	void moved_from(const GPS_loc& origin);	// keeps mob_index current; call after writing GPSpos directly
 
 	/// <returns>true iff continuing</returns>
 	bool flung(int& flvel, GPS_loc& loc);
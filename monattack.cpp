@@ -362,7 +362,7 @@ void mattack::growplants(game *g, monster *z)
   for (int j = -3; j <= 3; j++) {
    if (i == 0 && j == 0) j++;
    point dest(z->pos.x + i, z->pos.y + j);
-   auto& t = g->m.ter(dest);
+   auto t = g->m.ter(dest);
    if (!g->m.has_flag(diggable, dest) && one_in(4))
     t = t_dirt;
    else if (one_in(3) && g->m.is_destructable(dest))
@@ -380,7 +380,7 @@ void mattack::growplants(game *g, monster *z)
    for (int j = -5; j <= 5; j++) {
 	if (0 == i && 0 == j) j++;
 	point dest(z->pos.x + i, z->pos.y + j);
-	auto& t = g->m.ter(dest);
+	auto t = g->m.ter(dest);
      if (t_tree_young == t) t = t_tree; // Young tree => tree
      else if (t_underbrush == t) { // Underbrush => young tree
          if (auto _mob = g->mob_at(dest)) std::visit(grow_underbrush(*z), *_mob);
@@ -548,7 +548,7 @@ void mattack::triffid_heartbeat(game *g, monster *z)
   const zaimoni::gdi::box<point> span(g->u.pos, z->pos + 3*Direction::NW);
 
   static auto grow_wall = [&](const point& dest) {
-      auto& t = g->m.ter(dest);
+      auto t = g->m.ter(dest);
       if (g->is_empty(dest) && one_in(4)) t = t_root_wall;
       else if (t_root_wall == t && one_in(10)) t = t_dirt;
   };
@@ -1070,7 +1070,7 @@ void mattack::stare(game *g, monster *z)
   messages.add("A piercing beam of light bursts forth!");
   std::vector<point> sight = line_to(z->pos, g->u.pos, 0);
   for (const point& view : sight) {
-   auto& t = g->m.ter(view);
+   auto t = g->m.ter(view);
    if (any<t_reinforced_glass_v, t_reinforced_glass_h>(t)) break;
    if (g->m.is_destructable(view)) t = t_rubble;
   }
@@ -1,7 +1,7 @@
 #include "mongroup.h"
 #include <string.h>
 
-static const char* const JSON_transcode[] = {
+static constexpr const char* JSON_transcode[] = {
 	"forest",
 	"ant",
 	"bee",
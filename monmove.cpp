@@ -5,6 +5,7 @@
 #include "rng.h"
 #include "line.h"
 #include "recent_msg.h"
+#include "profiler.hpp"
 
 #include <stdlib.h>
 
@@ -61,6 +62,7 @@ void monster::wander_to(const point& pt, int f)
 
 void monster::plan(game *g)
 {
+ profiler::scope timing(profiler::MON_PLAN);
  int sightrange = g->light_level();
  auto could_see = g->mobs_with_range(GPSpos, sightrange).value(); // should be non-empty as I, monster, am in range
 
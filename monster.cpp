@@ -7,12 +7,12 @@
 #include "om_cache.hpp"
 #include "saveload.h"
 #include "stl_limits.h"
-#include "posix_time.h"
+#include "animation.hpp"
 
 #include <fstream>
 #include <stdlib.h>
 
-static const char* const JSON_transcode_meffects[] = {
+static constexpr const char* JSON_transcode_meffects[] = {
 	"BEARTRAP",
 	"POISONED",
 	"ONFIRE",
@@ -55,9 +55,9 @@ monster::monster(const mtype* t, GPS_loc origin) noexcept
 
 DEFINE_ACID_ASSIGN_W_MOVE(monster)
 
-void monster::screenpos_set(point pt) { GPSpos = overmap::toGPS(pos = pt); }
-void monster::screenpos_set(int x, int y) { GPSpos = overmap::toGPS(pos = point(x, y)); }
-void monster::screenpos_add(point delta) { GPSpos = overmap::toGPS(pos += delta); }
+void monster::screenpos_set(point pt) { set_screenpos(pos = pt); }
+void monster::screenpos_set(int x, int y) { set_screenpos(pos = point(x, y)); }
+void monster::screenpos_add(point delta) { set_screenpos(pos += delta); }
 
 void monster::poly(const mtype *t)
 {
@@ -642,17 +642,22 @@ void monster::fling(int dir, int flvel)
 
     tileray tdir(dir);
 
+    const animation anim(g->w_terrain, animation::FLIGHT);
     int range = flvel / 10;
     decltype(auto) loc = GPSpos;
     while (range > 0) {
         tdir.advance();
+        const auto from = GPSpos;
         loc = GPSpos + point(tdir.dx(), tdir.dy());
         if (!flung(flvel, loc)) break;
         set_screenpos(loc);
         range--;
         steps++;
-        timespec ts = { 0, 50000000 };   // Timespec for the animation
-        nanosleep(&ts, nullptr);
+        if (anim && g->u.see(loc)) {
+            if (g->u.see(from)) map::drawsq(g->w_terrain, g->u, from, false, true);
+            draw(g->w_terrain, g->u.pos, false);
+            anim.frame();
+        }
     }
 
     if (!is<swimmable>(loc.ter())) {
@@ -131,7 +131,7 @@ void mtype::do_special_attack(monster& viewpoint) const
 }
 #endif
 
-static const char* JSON_transcode[num_monsters] = {
+static constexpr const char* JSON_transcode[num_monsters] = {
 	"mon_null",
 	"mon_squirrel",
 	"mon_rabbit",
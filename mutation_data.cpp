@@ -564,7 +564,7 @@ land by 20%, but makes your movement silent.  However, they also increase\n\
 your swimming speed." }
 };
 
-static const char* const JSON_transcode_mutation_categories[] = {
+static constexpr const char* JSON_transcode_mutation_categories[] = {
 	"NULL",
 	"LIZARD",
 	"BIRD",
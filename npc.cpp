@@ -40,13 +40,13 @@ void npc::global_toJSON(cataclysm::JSON& dest)
     if (MIN_ID < next_id) dest.set("npc", std::to_string(next_id));
 }
 
-static const char* const JSON_transcode_favors[] = {
+static constexpr const char* JSON_transcode_favors[] = {
 	"CASH",
 	"ITEM",
 	"TRAINING"
 };
 
-static const char* const JSON_transcode_npc_attitude[] = {
+static constexpr const char* JSON_transcode_npc_attitude[] = {
 	"NULL",
 	"TALK",
 	"TRADE",
@@ -65,7 +65,7 @@ static const char* const JSON_transcode_npc_attitude[] = {
 	"KIDNAPPED"
 };
 
-static const char* const JSON_transcode_npc_class[] = {
+static constexpr const char* JSON_transcode_npc_class[] = {
 	"NONE",
 	"SHOPKEEP",
 	"HACKER",
@@ -77,7 +77,7 @@ static const char* const JSON_transcode_npc_class[] = {
 	"BOUNTY_HUNTER"
 };
 
-static const char* const JSON_transcode_npc_mission[] = {
+static constexpr const char* JSON_transcode_npc_mission[] = {
 	"NULL",
 	"RESCUE_U",
 	"SHELTER",
@@ -86,7 +86,7 @@ static const char* const JSON_transcode_npc_mission[] = {
 	"KIDNAPPED"
 };
 
-static const char* const JSON_transcode_talk[] = {
+static constexpr const char* JSON_transcode_talk[] = {
 	"DONE",
 	"MISSION_LIST",
 	"MISSION_LIST_ASSIGNED",
@@ -136,7 +136,7 @@ static const char* const JSON_transcode_talk[] = {
 	"OPINION"
 };
 
-static const char* const JSON_transcode_engage[] = {
+static constexpr const char* JSON_transcode_engage[] = {
 	"NONE",
 	"CLOSE",
 	"WEAK",
@@ -144,7 +144,7 @@ static const char* const JSON_transcode_engage[] = {
 	"ALL"
 };
 
-static const char* const JSON_transcode_npc_needs[] = {
+static constexpr const char* JSON_transcode_npc_needs[] = {
 	"none",
 	"ammo",
 	"weapon",
@@ -953,9 +953,8 @@ void npc::make_shopkeep(game *g, oter_id type)  // some other enum was intended
 
 void npc::spawn_at(const GPS_loc& _GPSpos)
 {
-    GPSpos = _GPSpos;
+    set_screenpos(_GPSpos);
     landing_zone_ok();
-	if (auto dest = game::active()->toScreen(GPSpos)) pos = *dest;
 }
 
 skill npc::best_skill() const
@@ -1095,8 +1094,10 @@ void npc::perform_mission(game *g)
    else if (-2 > delta.x) delta.x = -2;
    if (2 < delta.y) delta.y = 2;
    else if (-2 > delta.y) delta.y = -2;
-   GPSpos.first.x += delta.x;
-   GPSpos.first.y += delta.y;
+   auto dest = GPSpos;
+   dest.first.x += delta.x;
+   dest.first.y += delta.y;
+   set_screenpos(dest);
    attitude = NPCATT_DEFEND;
   }
   break;
@@ -1104,8 +1105,10 @@ void npc::perform_mission(game *g)
   break;	// Just stay where we are
  default:	// Random Walk
   if (int(messages.turn) % 24 == 0) {
-   GPSpos.first.x += 2 * rng(-1, 1);
-   GPSpos.first.y += 2 * rng(-1, 1);
+   auto dest = GPSpos;
+   dest.first.x += 2 * rng(-1, 1);
+   dest.first.y += 2 * rng(-1, 1);
+   set_screenpos(dest);
   }
  }
 }
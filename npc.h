@@ -471,6 +471,7 @@ public:
 private:
  void set_destination(game *g);	// Pick a place to go
  void go_to_destination(game *g); // Move there; on the micro scale
+ std::optional<point> next_waypoint(game *g); // Local target along coarse_path; replans as needed
  void reach_destination() { goal = std::nullopt; } // We made it!
 
 public:
@@ -528,6 +529,8 @@ public:
  bool has_new_items; // If true, we have something new and should re-equip
 
  std::vector<point> path;	// Our movement plans
+ std::vector<std::pair<tripoint, unsigned char> > coarse_path;	// submap_graph::region sequence toward goal; transient, not saved
+ std::optional<std::pair<OM_loc<2>, int> > coarse_failed;	// goal no route was found to, and the turn to try again; transient, not saved
 
 
 // Personality & other defining characteristics
@@ -3,8 +3,10 @@
 #include "game.h"
 #include "line.h"
 #include "mapbuffer.h"
+#include "submap_graph.hpp"
 #include "act_obj.h"
 #include "recent_msg.h"
+#include "profiler.hpp"
 #include "fragment.inc/rng_box.hpp"
 #include "Zaimoni.STL/functional.hpp"
 
@@ -285,6 +287,7 @@ struct ratio_index
 // class npc functions!
 void npc::move(game *g)
 {
+ profiler::scope timing(profiler::NPC_MOVE);
  wand.tick();	// countdown timers
  pl.tick();
 
@@ -1171,7 +1174,7 @@ bool player::landing_zone_ok() // \todo more complex approach; favor "near entry
         }
     }
     const bool ret = (0 < lz_ub);
-    if (ret) GPSpos.second = lz[rng(0, lz_ub - 1)];
+    if (ret) set_screenpos(GPS_loc(GPSpos.first, lz[rng(0, lz_ub - 1)]));
     return ret;
 }
 
@@ -1179,7 +1182,9 @@ bool player::can_enter(const GPS_loc& _GPSpos) const // should act like player::
 {
 	if (const auto sm = MAPBUFFER.lookup_submap(_GPSpos.first)) {
 		const auto g = game::active();
-		if (g->mob_at(_GPSpos)) return false; // do not spawn on monsters or NPCs; might need to revise when long-range move planning
+		if (const auto who = g->mob_at(_GPSpos)) { // do not spawn on monsters or NPCs; might need to revise when long-range move planning
+			if (this != std::visit(mobile::cast(), *who)) return false;
+		}
 		if (decltype(auto) pos = g->toScreen(_GPSpos)) {
 			// destination is actually in reality bubble: we are contemplating spawning
 			const auto& m = g->m;
@@ -2093,6 +2098,44 @@ void npc::set_destination(game *g)
  // * long_term_goal_action: post-process with "drift to nearest acceptable" of some kind
 }
 
+std::optional<point> npc::next_waypoint(game *g)
+{
+	static constexpr const int lookahead = 2;	// submaps; keeps the refining map::route window small
+	static constexpr const int retry_delay = 100;	// turns; an unreachable goal is not searched for every turn
+
+	const auto find_here = [&]() {
+		return std::find_if(coarse_path.begin(), coarse_path.end(), [&](const auto& r) { return r.first == GPSpos.first; });
+	};
+
+	auto here = find_here();
+	const bool stale = coarse_path.empty() || coarse_path.end() == here
+		|| overmap::toOvermap(GPS_loc(coarse_path.back().first, point(0))) != *goal;
+	if (stale) {
+		if (coarse_failed && coarse_failed->first == *goal && int(messages.turn) < coarse_failed->second) return std::nullopt;
+		if (auto plan = submap_graph::get().route(GPSpos, *goal)) {
+			coarse_path = std::move(*plan);
+			coarse_failed.reset();
+		} else {
+			coarse_path.clear();
+			coarse_failed = std::pair(*goal, int(messages.turn) + retry_delay);
+			return std::nullopt;
+		}
+		here = find_here();
+		if (coarse_path.end() == here) return std::nullopt;
+	}
+	coarse_path.erase(coarse_path.begin(), here);	// already traversed
+
+	// furthest region of the plan still close enough to refine with the tile-level A*
+	auto waypoint = coarse_path.begin();
+	for (auto it = coarse_path.begin(); it != coarse_path.end(); ++it) {
+		const tripoint delta = it->first - GPSpos.first;
+		if (lookahead < std::max(abs(delta.x), abs(delta.y))) break;
+		waypoint = it;
+	}
+	if (auto dest = submap_graph::get().nearest(*waypoint, GPSpos)) return g->toScreen(*dest);
+	return std::nullopt;
+}
+
 void npc::go_to_destination(game *g)
 {
 	if (!goal) return;	// invariant failure
@@ -2101,7 +2144,21 @@ void npc::go_to_destination(game *g)
   if (goal == om) {	// We're at our desired map square!
    pause();
    reach_destination();
+   return;
   }
+
+  // long-range plan first; the local search below is the historical fallback
+  if (const auto dest = next_waypoint(g)) {
+   path = g->m.route(pos, *dest);
+   if (!path.empty() && can_move_to(g->m, path[0])) {
+    move_to_next(g);
+    om = overmap::toOvermap(GPSpos);	// GPSpos updated so this updates
+    if (goal == om) reach_destination();	// We're at our desired map square!
+    return;
+   }
+   coarse_path.clear();	// plan disagrees with local conditions (vehicles, monsters); replan next time
+  }
+
   // NPCs historically don't go underground/change Z levels much \todo fix as part of long-range pathing
   point s(goal->first.x==om.first.x && goal->first.y==om.second.y ? cmp(goal->second, om.second) : cmp(point(om.first.x,om.first.y),point(goal->first.x,goal->first.y)));
 // sx and sy are now equal to the direction we need to move in
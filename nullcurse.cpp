@@ -0,0 +1,68 @@
+#if HEADLESS
+
+// curses backend that draws nothing, for the headless simulation; implements catacurse.h
+// Keys come from the headless singleton.
+
+#include "catacurse.h"
+#include "headless.hpp"
+
+struct WINDOW {
+	int height;
+	int width;
+};
+
+static WINDOW screen = { 25, 80 };	// fixed, so screen-dependent options do not vary between runs
+
+static WINDOW* real(WINDOW* win) { return win ? win : &screen; }
+
+WINDOW *initscr(void) { return &screen; }
+int endwin(void) { return OK; }
+
+WINDOW *newwin(int nlines, int ncols, int begin_y, int begin_x) { return new WINDOW{ nlines, ncols }; }
+int delwin(WINDOW *win)
+{
+	if (win && &screen != win) delete win;
+	return OK;
+}
+
+int getmaxx(WINDOW *win) { return real(win)->width; }
+int getmaxy(WINDOW *win) { return real(win)->height; }
+
+int getch(void) { return headless::get().key(false); }
+void timeout(int delay) {}
+
+int wborder(WINDOW *win, chtype ls, chtype rs, chtype ts, chtype bs, chtype tl, chtype tr, chtype bl, chtype br) { return OK; }
+int wrefresh(WINDOW *win) { return OK; }
+int refresh(void) { return OK; }
+int mvwprintw(WINDOW *win, int y, int x, const char *fmt, ...) { return OK; }
+int mvprintw(int y, int x, const char *fmt, ...) { return OK; }
+int wprintw(WINDOW *win, const char *fmt, ...) { return OK; }
+int printw(const char *fmt, ...) { return OK; }
+int werase(WINDOW *win) { return OK; }
+int wclear(WINDOW *win) { return OK; }
+int clear(void) { return OK; }
+int erase(void) { return OK; }
+int start_color(void) { return OK; }
+int init_pair(short pair, short f, short b) { return OK; }
+int mvwaddch(WINDOW *win, int y, int x, const chtype ch) { return OK; }
+int mvaddch(int y, int x, const chtype ch) { return OK; }
+int waddch(WINDOW *win, const chtype ch) { return OK; }
+int wattron(WINDOW *win, int attrs) { return OK; }
+int wattroff(WINDOW *win, int attrs) { return OK; }
+int attron(int attrs) { return OK; }
+int attroff(int attrs) { return OK; }
+int wmove(WINDOW* win, int y, int x) { return OK; }
+int waddnstr(WINDOW* win, const char* str, int n) { return OK; }
+int mvwaddnstr(WINDOW* win, int y, int x, const char* str, int n) { return OK; }
+
+int noecho(void) { return OK; }
+int cbreak(void) { return OK; }
+int keypad(WINDOW* faux, bool bf) { return OK; }
+int curs_set(int visibility) { return OK; }
+
+bool load_tile(const char* src) { return false; }
+void flush_tilesheets() {}
+bool mvwaddbgtile(WINDOW *win, int y, int x, const char* bgtile) { return false; }
+bool mvwaddfgtile(WINDOW *win, int y, int x, const char* fgtile) { return false; }
+
+#endif
@@ -1,13 +1,8 @@
 #include "om_cache.hpp"
 #include "game.h"
+#include "options.h"
 
-om_cache::~om_cache()
-{
-	for (auto& x : _cache) {
-		delete x.second.second;
-		x.second.second = nullptr;
-	}
-}
+om_cache::~om_cache() = default;
 
 om_cache& om_cache::get()
 {
@@ -15,41 +10,88 @@ om_cache& om_cache::get()
 	return ooao;
 }
 
-// status coding: 0 unread, 1 read, 2 written to
-overmap* om_cache::get(const tripoint& x)
+size_t om_cache::budget()
 {
-	if (x == game::active()->cur_om.pos) return &(game::active()->cur_om);
-	if (_cache.count(x)) {
-		auto& ret = _cache[x];
-		ret.first = 2;
-		return ret.second;
-	}
+	return (size_t)option_table::get()[OPT_OVERMAP_CACHE] << 20;
+}
+
+om_cache::stats om_cache::statistics() const
+{
+	stats ret = _stats;
+	ret.resident = _cache.size();
+	ret.bytes = _bytes;
+	ret.budget = budget();
+	return ret;
+}
+
+// terrain and seen arrays dominate
+static size_t footprint(const overmap& src)
+{
+	return sizeof(overmap) + src.npcs_size() * sizeof(npc) + src.zg.size() * sizeof(mongroup) + src.radios.size() * sizeof(radio_tower);
+}
+
+overmap* om_cache::find(const tripoint& x, bool write)
+{
+	auto it = _cache.find(x);
+	if (_cache.end() == it) return nullptr;
+	entry& working = it->second;
+	if (write) working.dirty = true;
+	_lru.splice(_lru.begin(), _lru, working.lru);
+	const size_t bytes = footprint(*working.om);
+	_bytes += bytes - working.bytes;
+	working.bytes = bytes;
+	_stats.hits++;
+	return working.om.get();
+}
+
+overmap& om_cache::insert(const tripoint& x, std::unique_ptr<overmap>&& src, bool dirty)
+{
+	_on_disk[x] = true;	// constructing an overmap saves it, if it was not already on the hard drive
+	auto it = _cache.find(x);
+	if (_cache.end() != it) drop(it);	// constructing src may have cached its neighbors, but not itself
+	_lru.push_front(x);
+	const size_t bytes = footprint(*src);
+	_bytes += bytes;
+	return *(_cache[x] = entry{ std::move(src), dirty, bytes, _lru.begin() }).om;
+}
+
+bool om_cache::on_disk(const tripoint& x)
+{
+	auto it = _on_disk.find(x);
+	if (_on_disk.end() != it) return it->second;
+	_stats.probes++;
+	bool ret = false;
 	const auto filename(overmap::terrain_filename(x));
-	if (auto f = fopen(filename.c_str(), "r")) {	// check whether file exists before triggering loading
+	if (auto f = fopen(filename.c_str(), "r")) {
 		fclose(f);
-		std::unique_ptr<overmap> ret(new overmap(game::active(), x.x, x.y, x.z));
-		_cache[x] = std::pair(2, ret.get());
-		return ret.release();
+		ret = true;
 	}
-	return nullptr;
+	return _on_disk[x] = ret;
+}
+
+void om_cache::drop(std::map<tripoint, entry>::iterator it)
+{
+	_bytes -= it->second.bytes;
+	_lru.erase(it->second.lru);
+	_cache.erase(it);
+}
+
+overmap* om_cache::get(const tripoint& x)
+{
+	if (x == game::active()->cur_om.pos) return &(game::active()->cur_om);
+	if (auto ret = find(x, true)) return ret;
+	if (!on_disk(x)) return nullptr;	// check whether file exists before triggering loading
+	_stats.misses++;
+	return &insert(x, std::make_unique<overmap>(game::active(), x.x, x.y, x.z), true);
 }
 
 const overmap* om_cache::r_get(const tripoint& x)
 {
 	if (x == game::active()->cur_om.pos) return &(game::active()->cur_om);
-	if (_cache.count(x)) {
-		auto& ret = _cache[x];
-		ret.first = 1;	// would need const cast to update
-		return ret.second;
-	}
-	const auto filename(overmap::terrain_filename(x));
-	if (auto f = fopen(filename.c_str(), "r")) {	// check whether file exists before triggering loading
-		fclose(f);
-		std::unique_ptr<overmap> ret(new overmap(game::active(), x.x, x.y, x.z));
-		_cache[x] = std::pair(1, ret.get());
-		return ret.release();
-	}
-	return nullptr;
+	if (auto ret = find(x, false)) return ret;
+	if (!on_disk(x)) return nullptr;	// check whether file exists before triggering loading
+	_stats.misses++;
+	return &insert(x, std::make_unique<overmap>(game::active(), x.x, x.y, x.z), false);
 }
 
 // \todo get/r_get variants that target overmap properties, rather than the tripoint coordinate
@@ -63,73 +105,65 @@ const overmap* om_cache::r_get(const tripoint& x)
 overmap& om_cache::create(const tripoint& x)	// only if needed
 {
 	if (x == game::active()->cur_om.pos) return game::active()->cur_om;
-	if (_cache.count(x)) {
-		auto& ret = _cache[x];
-		ret.first = 2;
-		return *ret.second;
-	}
-	std::unique_ptr<overmap> ret(new overmap(game::active(), x.x, x.y, x.z));
-	_cache[x] = std::pair(2, ret.get());
-	return *(ret.release());
+	if (auto ret = find(x, true)) return *ret;
+	_stats.misses++;
+	return insert(x, std::make_unique<overmap>(game::active(), x.x, x.y, x.z), true);
 }
 
 const overmap& om_cache::r_create(const tripoint& x)	// only if needed
 {
 	if (x == game::active()->cur_om.pos) return game::active()->cur_om;
-	if (_cache.count(x)) {
-		auto& ret = _cache[x];
-		ret.first = 1;	// would need const cast to update
-		return *ret.second;
-	}
-	std::unique_ptr<overmap> ret(new overmap(game::active(), x.x, x.y, x.z));
-	_cache[x] = std::pair(1, ret.get());	// creation saved to hard drive already
-	return *(ret.release());
+	if (auto ret = find(x, false)) return *ret;
+	_stats.misses++;
+	return insert(x, std::make_unique<overmap>(game::active(), x.x, x.y, x.z), false);	// creation saved to hard drive already
 }
 
 
 void om_cache::expire()
 {
-	std::vector<tripoint> discard;
-	for (auto& x : _cache) {
-		if (0 >= x.second.first) discard.push_back(x.first);	// not even accessed
-		else if (1 == x.second.first) {
-			// read but not written to: demote
-			x.second.first = 0;
+	const size_t limit = budget();
+	if (limit >= _bytes) return;
+	const auto& name = game::active()->u.name;
+	while (limit < _bytes && !_lru.empty()) {
+		auto it = _cache.find(_lru.back());
+		if (it->second.dirty) {
+			it->second.om->save(name);
+			_stats.write_backs++;
 		}
-		// was written to...do not have save command so leave alone
+		drop(it);
+		_stats.evictions++;
 	}
-	if (!discard.empty()) for (const auto& kill : discard) _cache.erase(kill);
 }
 
 void om_cache::save()
 {
-	std::vector<tripoint> discard;
+	const auto& name = game::active()->u.name;
 	for (auto& x : _cache) {
-		if (0 >= x.second.first) discard.push_back(x.first);	// not even accessed
-		else if (2 <= x.second.first) {	// was written to
-			x.second.second->save(game::active()->u.name);
-			x.second.first = 1;	// treat as read-from now
-		}
+		if (!x.second.dirty) continue;
+		x.second.om->save(name);
+		x.second.dirty = false;
 	}
-	if (!discard.empty()) for (const auto& kill : discard) _cache.erase(kill);
 }
 
 void om_cache::load(overmap& dest, const tripoint& x)	// dest is typically game::cur_om
 {
 	if (x == dest.pos) return;
-	if (_cache.count(dest.pos)) {	// should not happen
-		auto& working = _cache[dest.pos];
-		*working.second = std::move(dest);
-		working.first = 1;
-	}
-	if (_cache.count(x)) {
-		auto& working = _cache[x];
-		dest = std::move(*working.second);
-		delete working.second;
-		_cache.erase(x);
-		return;
+	std::unique_ptr<overmap> incoming;
+	auto it = _cache.find(x);
+	if (_cache.end() != it) {
+		incoming = std::move(it->second.om);
+		drop(it);
+		_stats.hits++;
+	} else {
+		// dest is still game::cur_om here, for the neighbors of a newly generated overmap
+		incoming = std::make_unique<overmap>(game::active(), x.x, x.y, x.z);
+		_on_disk[x] = true;
+		_stats.misses++;
 	}
-	dest = overmap(game::active(), x.x, x.y, x.z);
+	// callers need not have saved the outgoing overmap
+	const tripoint outgoing(dest.pos);
+	insert(outgoing, std::make_unique<overmap>(std::move(dest)), true);
+	dest = std::move(*incoming);
 }
 
 void om_cache::scan(std::function<std::optional<bool>(overmap&)> op)
@@ -137,8 +171,9 @@ void om_cache::scan(std::function<std::optional<bool>(overmap&)> op)
 	if (op(game::active()->cur_om)) return;
 
 	for (decltype(auto) x : _cache) {
-		if (auto code = op(*x.second.second)) {
-			x.second.first = 2;	// write access
+		if (auto code = op(*x.second.om)) {
+			x.second.dirty = true;	// write access
+			_lru.splice(_lru.begin(), _lru, x.second.lru);
 			if (*code) return;
 		}
 	}
@@ -151,8 +186,8 @@ void om_cache::scan_r(std::function<std::optional<bool>(const overmap&)> op)
 	if (op(game::active()->cur_om)) return;
 
 	for (decltype(auto) x : _cache) {
-		if (auto code = op(*x.second.second)) {
-			x.second.first = 1;	// read access
+		if (auto code = op(*x.second.om)) {
+			_lru.splice(_lru.begin(), _lru, x.second.lru);	// read access
 			if (*code) return;
 		}
 	}
@@ -3,37 +3,72 @@
 
 #include "enums.h"
 #include <functional>
+#include <list>
 #include <map>
+#include <memory>
 #include <optional>
 #include <utility>
 
 class overmap;
 
 // singleton
+// Overmaps other than game::cur_om, least recently used first out once over the byte budget (OPT_OVERMAP_CACHE).
+// Overmaps handed out for writing are saved before they are dropped.
 class om_cache
 {
+public:
+	struct stats {
+		size_t hits;
+		size_t misses;	// loaded or generated
+		size_t evictions;
+		size_t write_backs;	// evictions that had to save first
+		size_t probes;	// existence checks that went to the hard drive
+		size_t resident;
+		size_t bytes;	// estimated
+		size_t budget;
+	};
+
 private:
-	std::map<tripoint, std::pair<signed char,overmap*> > _cache;	// could use std::unique_ptr in place of raw pointer here and default destructor instead
-	
-	om_cache() = default;
+	struct entry {
+		std::unique_ptr<overmap> om;
+		bool dirty;	// handed out for writing since last saved
+		size_t bytes;	// estimated footprint, as of last access
+		std::list<tripoint>::iterator lru;
+	};
+
+	std::map<tripoint, entry> _cache;
+	std::list<tripoint> _lru;	// most recently used first
+	std::map<tripoint, bool> _on_disk;	// existence of overmap files; only this process creates them
+	size_t _bytes;
+	stats _stats;
+
+	om_cache() : _bytes(0), _stats{} {}
 	~om_cache();
 	om_cache(const om_cache& src) = delete;
 	om_cache(om_cache&& src) = delete;
 	om_cache& operator=(const om_cache& src) = delete;
 	om_cache& operator=(om_cache&& src) = delete;
+
+	overmap* find(const tripoint& x, bool write);
+	overmap& insert(const tripoint& x, std::unique_ptr<overmap>&& src, bool dirty);
+	bool on_disk(const tripoint& x);
+	void drop(std::map<tripoint, entry>::iterator it);
 public:
 	static om_cache& get();
 	overmap* get(const tripoint& x);
 	overmap& create(const tripoint& x);	// only if needed
 	const overmap* r_get(const tripoint& x);
 	const overmap& r_create(const tripoint& x);	// only if needed
-	void expire();	// all overmaps not used flushed to hard drive; usage flag reset
+	void expire();	// evicts least recently used overmaps until within budget
 	void save();
-	void load(overmap& dest, const tripoint& x);
+	void load(overmap& dest, const tripoint& x);	// outgoing dest is cached, and saved when evicted
 
 	// op returns: std::nullopt no material access; true to early-exit
 	void scan(std::function<std::optional<bool>(overmap&)> op);
 	void scan_r(std::function<std::optional<bool>(const overmap&)> op);
+
+	static size_t budget();
+	stats statistics() const;
 };
 
 #endif
@@ -25,6 +25,8 @@ static constexpr int default_int(option_key opt)
 	switch (opt)
 	{
 	case OPT_FONT_HEIGHT: return 16;
+	case OPT_OVERMAP_CACHE: return 64;
+	case OPT_ANIMATION_SPEED: return 1;
 	case OPT_VIEW: return 25;
 	case OPT_PANELX: return 55;
 	case OPT_SCREENWIDTH: return default_int(OPT_VIEW) + default_int(OPT_PANELX);
@@ -46,6 +48,7 @@ static constexpr double min_numeric(option_key opt)
 	switch (opt)
 	{
 	case OPT_FONT_HEIGHT: return 10;	// historically deemed unreadable if calculated width 4 or lower; likewise height 4 or lower
+	case OPT_OVERMAP_CACHE: return 1;	// about six overmaps
 	default: return 0;
 	}
 }
@@ -64,8 +67,11 @@ static constexpr const char* JSON_key(option_key opt)	// \todo micro-optimize th
 	case OPT_AUTOSAFEMODE: return "auto safe mode";
 	case OPT_NPCS: return "NPCs";
 	case OPT_LOAD_TILES: return "load tiles";
+	case OPT_COMPRESS_SAVES: return "compress saves";
 	case OPT_FONT_HEIGHT: return "font height";
 	case OPT_EXTRA_MARGIN: return "extra bottom-right margin";
+	case OPT_OVERMAP_CACHE: return "overmap cache MiB";
+	case OPT_ANIMATION_SPEED: return "animation speed";
 /*	case OPT_VIEW: return "screen height, i.e. view diameter"; // don't want to be able to set these by normal UI
 	case OPT_PANELX: return "side panel width";
 	case OPT_SCREENWIDTH: return "screen width"; */
@@ -206,8 +212,11 @@ const char* option_name(option_key key)
   case OPT_AUTOSAFEMODE:	return "Auto-Safemode on by default";
   case OPT_NPCS:			return "Generate NPCs";
   case OPT_LOAD_TILES:		return "use tileset (requires restart)";
+  case OPT_COMPRESS_SAVES:	return "Compress save files";
   case OPT_FONT_HEIGHT:		return "Font height (requires restart)";
   case OPT_EXTRA_MARGIN:	return "Extra bottom-right margin (requires restart)";
+  case OPT_OVERMAP_CACHE:	return "Overmap cache (MiB)";
+  case OPT_ANIMATION_SPEED:	return "Animation speed (0: off)";
   case OPT_FONT:	return "Font (requires restart)";
   default:			return "Unknown Option (BUG)";
  }
@@ -27,8 +27,11 @@ OPT_SAFEMODE, // Safemode on by default?
 OPT_AUTOSAFEMODE, // Autosafemode on by default?
 OPT_NPCS,	// NPCs generated in game world
 OPT_LOAD_TILES,	// use tileset
+OPT_COMPRESS_SAVES,	// write save files in the compressed container
 OPT_FONT_HEIGHT,	// font height (ASCII)
 OPT_EXTRA_MARGIN,	// correction to margin to avoid clipping text
+OPT_OVERMAP_CACHE,	// MiB of overmaps kept in memory besides the current one
+OPT_ANIMATION_SPEED,	// divides the delay between animation frames; 0 turns animation off
 NUM_OPTION_KEYS,	// strict upper bound for legacy option editing UI
 OPT_VIEW = NUM_OPTION_KEYS, // formerly ui.h constants -- regenerated on startup
 OPT_PANELX,
@@ -76,6 +79,8 @@ public:
 	 {
 	 case OPT_FONT_HEIGHT:	return OPTTYPE_INT;
 	 case OPT_EXTRA_MARGIN:	return OPTTYPE_INT;
+	 case OPT_OVERMAP_CACHE:	return OPTTYPE_INT;
+	 case OPT_ANIMATION_SPEED:	return OPTTYPE_INT;
 	 case OPT_VIEW:	return OPTTYPE_INT;
 	 case OPT_PANELX: return OPTTYPE_INT;
 	 case OPT_SCREENWIDTH: return OPTTYPE_INT;
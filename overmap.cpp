@@ -4,6 +4,9 @@
 #include "saveload.h"
 #include "json.h"
 #include "om_cache.hpp"
+#include "savefile.hpp"
+#include "binary_io.hpp"
+#include "mob_index.hpp"
 #include "stl_limits.h"
 #include "line.h"
 #include "rng.h"
@@ -580,7 +583,10 @@ bool overmap::activate_npc(const size_t i, npcs_t& active_npc, const Badge<game>
     if (_npc->screen_pos()) {
         _npc->spawn_at(_npc->GPSpos);
         if (_npc->marked_for_death) _npc->die();
-        else active_npc.push_back(std::move(_npc));
+        else {
+            active_npc.push_back(std::move(_npc));
+            mob_index::get().invalidate();
+        }
         EraseAt(npcs, i);
         return true;
     }
@@ -593,6 +599,7 @@ void overmap::deactivate_npc(const size_t i, npcs_t& active_npc, const Badge<gam
     _npc->pos %= SEE;
     npcs.push_back(std::move(active_npc[i])); // \todo fix this as part of GPS conversion (GPS location could be "just over the overmap border")
     EraseAt(active_npc, i);
+    mob_index::get().invalidate();
 }
 
 void overmap::npcs_move(npcs_t& active_npc, const Badge<game>& auth)
@@ -734,19 +741,28 @@ static oter_id house(int dir)
 
 // *** BEGIN overmap FUNCTIONS ***
 
-oter_id& overmap::ter(int x, int y)
+// binary save formats; the text formats before them start with printable characters
+static const char ter_magic[4] = { '\x01', 'O', 'M', 'T' };	// terrain as runs: byte oter_id, varint length - 1
+static const char seen_magic[4] = { '\x01', 'O', 'M', 'S' };	// seen as bits, then notes as before
+
+static bool has_magic(const std::string& src, const char (&magic)[4])
 {
- if (x < 0 || x >= OMAPX || y < 0 || y >= OMAPY) return (discard<oter_id>::x = ot_null);
- return t[x][y];
+ return sizeof(magic) <= src.size() && 0 == memcmp(src.data(), magic, sizeof(magic));
+}
+
+overmap::ter_ref overmap::ter(int x, int y)
+{
+ if (x < 0 || x >= OMAPX || y < 0 || y >= OMAPY) return ter_ref(&(discard<unsigned char>::x = ot_null));
+ return ter_ref(&t[x][y]);
 }
 
 oter_id overmap::ter(int x, int y) const
 {
     if (x < 0 || x >= OMAPX || y < 0 || y >= OMAPY) return ot_null;
-    return t[x][y];
+    return oter_id(t[x][y]);
 }
 
-oter_id& overmap::ter(OM_loc<2> OMpos)
+overmap::ter_ref overmap::ter(OM_loc<2> OMpos)
 {
     OMpos.self_normalize();
     return om_cache::get().create(OMpos.first).ter(OMpos.second);
@@ -820,13 +836,21 @@ bool overmap::_is_safe(const OM_loc<1>& loc)
     return true;
 }
 
-bool& overmap::seen(int x, int y)
+overmap::seen_ref overmap::seen(int x, int y)
+{
+ if (x < 0 || x >= OMAPX || y < 0 || y >= OMAPY) return seen_ref(&(discard<unsigned long long>::x = 0), 0);
+ const unsigned n = x * OMAPY + y;
+ return seen_ref(s + n / 64, n % 64);
+}
+
+bool overmap::seen(int x, int y) const
 {
- if (x < 0 || x >= OMAPX || y < 0 || y >= OMAPY) return (discard<bool>::x = false);
- return s[x][y];
+ if (x < 0 || x >= OMAPX || y < 0 || y >= OMAPY) return false;
+ const unsigned n = x * OMAPY + y;
+ return (s[n / 64] >> (n % 64)) & 1;
 }
 
-bool& overmap::seen(OM_loc<2> OMpos)
+overmap::seen_ref overmap::seen(OM_loc<2> OMpos)
 {
     OMpos.self_normalize();
     return om_cache::get().create(OMpos.first).seen(OMpos.second);
@@ -961,11 +985,7 @@ std::optional<point> overmap::display_notes() const
 
 void overmap::clear_terrain(oter_id src)
 {
-	for (int i = 0; i < OMAPY; i++) {
-		for (int j = 0; j < OMAPX; j++) {
-			t[i][j] = src;
-		}
-	}
+	memset(t, (unsigned char)src, sizeof(t));
 }
 
 void overmap::generate(game *g, const overmap* north, const overmap* east, const overmap* south, const overmap* west)
@@ -1881,7 +1901,7 @@ void overmap::put_buildings(int x, int y, int dir, const city& town)
 {
  int ychange = dir % 2, xchange = (dir + 1) % 2;
  for (int i = -1; i <= 1; i += 2) {
-  auto& terrain = ter(x + i * xchange, y + i * ychange);
+  auto terrain = ter(x + i * xchange, y + i * ychange);
   if ((ot_field == terrain) && !one_in(STREETCHANCE)) {
    const auto c_dist = calc_dist(x, y, town.x, town.y) / town.s;
    static_assert(std::is_floating_point_v<decltype(c_dist)>);   // above truncates for integral types
@@ -2018,7 +2038,7 @@ void overmap::build_lab(const city& origin)
    int tries = 0;
    do {
 	point stair(rng(origin.x - origin.s, origin.x + origin.s), rng(origin.y - origin.s, origin.y + origin.s));
-	auto& terrain = ter(stair);
+	auto terrain = ter(stair);
 	if (ot_lab == terrain) {
       terrain = ot_lab_stairs;
       numstairs++;
@@ -2196,7 +2216,7 @@ void overmap::make_hiway(int x1, int y1, int x2, int y2, oter_id base)
     dir = 1; // We are moving vertically
     x = next[1].x;
     y = next[1].y;
-	auto& terrain = ter(x, y);
+	auto terrain = ter(x, y);
     if (is_river(terrain)) terrain = ot_bridge_ns;
     else if (!is_road(*ot_range, x, y)) terrain = base;
    } else if (next.size() == 1) { // Y must be correct, take the x-change
@@ -2204,7 +2224,7 @@ void overmap::make_hiway(int x1, int y1, int x2, int y2, oter_id base)
     dir = 0; // We are moving horizontally
     x = next[0].x;
     y = next[0].y;
-	auto& terrain = ter(x, y);
+	auto terrain = ter(x, y);
 	if (is_river(terrain)) terrain = ot_bridge_ew;
     else if (!is_road(*ot_range, x, y)) terrain = base;
    } else {	// More than one eligible route; pick one randomly
@@ -2339,7 +2359,7 @@ void overmap::polish(oter_id min, oter_id max)
 // Main loop--checks roads and rivers that aren't on the borders of the map
  for (int x = 0; x < OMAPX; x++) {
   for (int y = 0; y < OMAPY; y++) {
-   auto& terrain = ter(x, y);
+   auto terrain = ter(x, y);
    if (terrain >= min && terrain <= max) {
     if (is_between<ot_road_null, ot_road_nesw>(terrain))
      good_road(ot_road_ns, x, y);
@@ -2374,7 +2394,7 @@ void overmap::polish(oter_id min, oter_id max)
 // Also, this leaves, say, 3x3 areas of road.  TODO: fix this?  courtyards etc?
  for (int y = 0; y < OMAPY - 1; y++) {
   for (int x = 0; x < OMAPX - 1; x++) {
-   auto& terrain = ter(x, y);
+   auto terrain = ter(x, y);
    if (terrain >= min && terrain <= max) {
     if (terrain == ot_road_nes && ter(x+1, y) == ot_road_nsw &&
         ter(x, y+1) == ot_road_nes && ter(x+1, y+1) == ot_road_nsw) {
@@ -2774,22 +2794,34 @@ void overmap::save(const std::string& name, int x, int y, int z) const
  plrfilename << "save/" << name << ".seen." << x << "." << y << "." << z;
  terfilename << "save/o." << x << "." << y << "." << z;
 
- std::ofstream fout(plrfilename.str().c_str());
- for (int j = 0; j < OMAPY; j++) {	// \todo good candidate for uuencoding
+ std::ostringstream fout;
+ fout.write(seen_magic, sizeof(seen_magic));
+ {
+ unsigned char bits[(OMAPX * OMAPY + 7) / 8] = {};
+ for (int j = 0; j < OMAPY; j++) {
   for (int i = 0; i < OMAPX; i++) {
-   if (seen(i, j))
-    fout << "1";
-   else
-    fout << "0";
+   const int n = j * OMAPX + i;
+   if (seen(i, j)) bits[n / 8] |= 1U << (n % 8);
   }
-  fout << std::endl;
+ }
+ fout.write(reinterpret_cast<const char*>(bits), sizeof(bits));
  }
  for(const auto& n : notes) fout << "N " << n << std::endl;
- fout.close();
- fout.open(terfilename.str().c_str(), std::ios_base::trunc);
- for (int j = 0; j < OMAPY; j++) {
-  for (int i = 0; i < OMAPX; i++)
-   fout << char(int(ter(i, j)) + 32);
+ savefile::get().write_binary(plrfilename.str(), fout.str());
+
+ // the terrain runs are the head; the save thread formats the rest
+ fout.str("");
+ fout.write(ter_magic, sizeof(ter_magic));
+ {
+ int n = 0;
+ while (OMAPX * OMAPY > n) {
+  const unsigned char code = t[n % OMAPX][n / OMAPX];
+  int run = 1;
+  while (OMAPX * OMAPY > n + run && code == t[(n + run) % OMAPX][(n + run) / OMAPX]) run++;
+  fout.put(char(code));
+  cataclysm::binary::write_uint(fout, run - 1);
+  n += run;
+ }
  }
  fout << std::endl;
 
@@ -2799,9 +2831,7 @@ void overmap::save(const std::string& name, int x, int y, int z) const
  saved.set("roads", JSON::encode(roads_out));
  saved.set("radios", JSON::encode(radios));
  saved.set("npcs", JSON::encode(npcs));
- fout << saved;
-
- fout.close();
+ savefile::get().write_binary(terfilename.str(), fout.str(), std::move(saved));
 }
 
 void overmap::saveall()
@@ -2826,18 +2856,35 @@ overmap::overmap(game* g, int x, int y, int z)
  plrfilename << "save/" << g->u.name << ".seen." << pos.x << "." << pos.y << "." << pos.z;
 
  const auto terfilename(terrain_filename(pos));
- std::ifstream fin(terfilename.c_str());
- if (fin.is_open()) {
-  for (int j = 0; j < OMAPY; j++) {
-   for (int i = 0; i < OMAPX; i++) {
-	const auto ter_code = fin.get() - 32;
-    // \todo: some sort of best-effort repair process?
-    if (!is_between(0, ter_code, num_ter_types - 1)) {
+ std::string contents;
+ if (savefile::get().read(terfilename, contents, true)) {
+  // \todo: some sort of best-effort repair process?
+  auto bad_ter = [&](int ter_code) {
         debuglog("Loaded bad ter!  %s; ter %d", terfilename.c_str(), ter_code);
         debugmsg("Loaded bad ter!  %s; ter %d", terfilename.c_str(), ter_code); // UI (in case it lasts long enough)
         throw std::runtime_error("terrain file damaged, not attempting automatic repair.");
+  };
+  std::istringstream fin;
+  if (has_magic(contents, ter_magic)) {
+   fin.str(std::move(contents));
+   fin.ignore(sizeof(ter_magic));
+   int n = 0;
+   while (OMAPX * OMAPY > n) {
+    const int ter_code = fin.get();
+    if (!is_between(0, ter_code, num_ter_types - 1)) bad_ter(ter_code);
+    const auto run = cataclysm::binary::read_uint(fin) + 1;
+    if (OMAPX * OMAPY - n < run) bad_ter(ter_code);
+    for (auto i = run; 0 < i; i--, n++) t[n % OMAPX][n / OMAPX] = (unsigned char)ter_code;
+   }
+  } else {	// text, as written before the binary format
+   savefile::get().read(terfilename, contents);
+   fin.str(std::move(contents));
+   for (int j = 0; j < OMAPY; j++) {
+    for (int i = 0; i < OMAPX; i++) {
+     const auto ter_code = fin.get() - 32;
+     if (!is_between(0, ter_code, num_ter_types - 1)) bad_ter(ter_code);
+     ter(i, j) = oter_id(ter_code);
     }
-    ter(i, j) = oter_id(ter_code);
    }
   }
   if ('{' != (fin >> std::ws).peek()) {
@@ -2845,36 +2892,56 @@ overmap::overmap(game* g, int x, int y, int z)
       debugmsg("Pre-V0.2.0 format?"); // UI (in case it lasts long enough)
       throw std::runtime_error("extremely archaic savefile (pre V0.2.0)?");
   }
-	  JSON om(fin);
-	  if (om.has_key("groups")) om["groups"].decode(zg);
-	  if (om.has_key("cities")) om["cities"].decode(cities);
-	  if (om.has_key("roads")) om["roads"].decode(roads_out);
-	  if (om.has_key("radios")) om["radios"].decode(radios);
-      if (om.has_key("npcs")) {
-          om["npcs"].decode(npcs);
-          // V0.2.2 this is the earliest we can repair the tripoint field for OM_loc-retyped npc::goal
-          for (auto& _npc : npcs) {
-              if (_npc->goal && _npc->goal->first == tripoint(INT_MAX)) {
-                  // V0.2.1- goal is point.  Assume our own location.
-                  _npc->goal->first = pos;
-              }
-          }
-      }
+	  cataclysm::JSON_reader om(fin);
+	  om.begin_object();
+	  while (om.next_key()) {
+		  const std::string& key = om.key();
+		  if ("groups" == key) om.decode(zg);
+		  else if ("cities" == key) om.decode(cities);
+		  else if ("roads" == key) om.decode(roads_out);
+		  else if ("radios" == key) om.decode(radios);
+		  else if ("npcs" == key) {
+			  om.decode(npcs);
+			  // V0.2.2 this is the earliest we can repair the tripoint field for OM_loc-retyped npc::goal
+			  for (auto& _npc : npcs) {
+				  if (_npc->goal && _npc->goal->first == tripoint(INT_MAX)) {
+					  // V0.2.1- goal is point.  Assume our own location.
+					  _npc->goal->first = pos;
+				  }
+			  }
+		  } else om.skip();
+	  }
 
 // Private/per-character data
-  fin.close();
-  fin.open(plrfilename.str().c_str());
-  if (fin.is_open()) {	// Load private seen data
-   for (int j = 0; j < OMAPY; j++) {
-    for (int i = 0; i < OMAPX; i++) {
-     seen(i, j) = (fin.get() == '1');
+  if (savefile::get().read(plrfilename.str(), contents, true)) {	// Load private seen data
+   clear_seen();
+   if (has_magic(contents, seen_magic)) {
+    fin.str(std::move(contents));
+    fin.clear();
+    fin.ignore(sizeof(seen_magic));
+    unsigned char bits[(OMAPX * OMAPY + 7) / 8] = {};
+    fin.read(reinterpret_cast<char*>(bits), sizeof(bits));	// truncated: rest unseen
+    for (int j = 0; j < OMAPY; j++) {
+     for (int i = 0; i < OMAPX; i++) {
+      const int n = j * OMAPX + i;
+      if ((bits[n / 8] >> (n % 8)) & 1) seen(i, j) = true;
+     }
+    }
+    fin.clear();
+   } else {	// text, as written before the binary format
+    savefile::get().read(plrfilename.str(), contents);
+    fin.str(std::move(contents));
+    fin.clear();
+    for (int j = 0; j < OMAPY; j++) {
+     for (int i = 0; i < OMAPX; i++) {
+      seen(i, j) = (fin.get() == '1');
+     }
+     fin >> std::ws;
     }
-	fin >> std::ws;
    }
    while (fin >> datatype) {	// Load private notes
     if (datatype == 'N') notes.push_back(om_note(fin));
    }
-   fin.close();
   } else {
    clear_seen();
   }
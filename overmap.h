@@ -51,6 +51,33 @@ class overmap
  public:
   using npcs_t = std::vector<std::shared_ptr<npc> >;
 
+  // terrain is stored a byte per cell; this stands in for oter_id&
+  class ter_ref {
+	  unsigned char* _x;
+  public:
+	  explicit ter_ref(unsigned char* x) noexcept : _x(x) {}
+	  ter_ref(const ter_ref& src) = default;
+	  ter_ref& operator=(const ter_ref& src) { *_x = *src._x; return *this; }
+	  ter_ref& operator=(oter_id src) { *_x = (unsigned char)src; return *this; }
+	  operator oter_id() const { return oter_id(*_x); }
+  };
+
+  // seen is stored a bit per cell; this stands in for bool&
+  class seen_ref {
+	  unsigned long long* _x;
+	  unsigned long long _mask;
+  public:
+	  seen_ref(unsigned long long* x, unsigned bit) noexcept : _x(x), _mask(1ULL << bit) {}
+	  seen_ref(const seen_ref& src) = default;
+	  seen_ref& operator=(const seen_ref& src) { return *this = (bool)src; }
+	  seen_ref& operator=(bool src) {
+		  if (src) *_x |= _mask;
+		  else *_x &= ~_mask;
+		  return *this;
+	  }
+	  operator bool() const { return *_x & _mask; }
+  };
+
   overmap() noexcept : pos(999, 999, 999) {};	// \todo: use truly impossible coordinates
   overmap(game *g, int x, int y, int z);
   ~overmap() = default;
@@ -81,9 +108,9 @@ class overmap
 // Interactive point choosing; used as the map screen
   std::optional<point> choose_point(game *g);
 
-  oter_id& ter(int x, int y);
-  oter_id& ter(const point& pt) { return ter(pt.x, pt.y); };
-  static oter_id& ter(OM_loc<2> OMpos);
+  ter_ref ter(int x, int y);
+  ter_ref ter(const point& pt) { return ter(pt.x, pt.y); };
+  static ter_ref ter(OM_loc<2> OMpos);
   oter_id ter(int x, int y) const;
   oter_id ter(const point& pt) const { return ter(pt.x, pt.y); };
   static oter_id ter_c(OM_loc<2> OMpos);
@@ -94,11 +121,11 @@ class overmap
   mongroup* valid_group(mon_id type, const point& pt); // pt is from matching high-resolution OM_loc
   static bool is_safe(const OM_loc<2>& loc); // true if monsters_at is empty, or only woodland
 
-  bool& seen(int x, int y);
-  bool& seen(const point& pt) { return seen(pt.x, pt.y); };
-  static bool& seen(OM_loc<2> OMpos);
-  bool seen(int x, int y) const { return const_cast<overmap*>(this)->seen(x, y); };	// \todo specialize?
-  bool seen(const point& pt) const { return const_cast<overmap*>(this)->seen(pt.x, pt.y); };
+  seen_ref seen(int x, int y);
+  seen_ref seen(const point& pt) { return seen(pt.x, pt.y); };
+  static seen_ref seen(OM_loc<2> OMpos);
+  bool seen(int x, int y) const;
+  bool seen(const point& pt) const { return seen(pt.x, pt.y); };
   static bool seen_c(OM_loc<2> OMpos);
   static void expose(OM_loc<2> OMpos);
 
@@ -135,8 +162,10 @@ class overmap
 
  private:
   npcs_t npcs; // submap is already bloated, so more efficient to have them here
-  oter_id t[OMAPX][OMAPY];
-  bool s[OMAPX][OMAPY];
+  static_assert((unsigned char)(-1) >= num_ter_types, "overmap terrain must fit in a byte");
+  static constexpr const size_t seen_words = (OMAPX * OMAPY + 63) / 64;
+  unsigned char t[OMAPX][OMAPY];	// oter_id
+  unsigned long long s[seen_words];	// bit x*OMAPY+y
   std::vector<om_note> notes;
   std::vector<city> roads_out;
   std::vector<city> cities;
@@ -13,7 +13,8 @@
 #include "recent_msg.h"
 #include "saveload.h"
 #include "zero.h"
-#include "posix_time.h"
+#include "animation.hpp"
+#include "gui.hpp"
 
 #include <array>
 #include <math.h>
@@ -1208,7 +1209,7 @@ std::string describe(const disease& dis, const player& p)
 }
 // end prototype for disease.cpp
 
-static const char* const JSON_transcode_activity[] = {
+static constexpr const char* JSON_transcode_activity[] = {
 	"RELOAD",
 	"READ",
 	"WAIT",
@@ -1220,7 +1221,7 @@ static const char* const JSON_transcode_activity[] = {
 	"TRAIN"
 };
 
-static const char* const JSON_transcode_disease[] = {
+static constexpr const char* JSON_transcode_disease[] = {
 	"GLARE",
 	"WET",
 	"COLD",
@@ -1294,7 +1295,7 @@ static const char* const JSON_transcode_disease[] = {
 	"CATCH_UP"
 };
 
-static const char* const JSON_transcode_hp_parts[] = {
+static constexpr const char* JSON_transcode_hp_parts[] = {
 	"head",
 	"torso",
 	"arm_l",
@@ -1303,7 +1304,7 @@ static const char* const JSON_transcode_hp_parts[] = {
 	"leg_r"
 };
 
-static const char* const JSON_transcode_morale[] = {
+static constexpr const char* JSON_transcode_morale[] = {
 	"FOOD_GOOD",
 	"MUSIC",
 	"MARLOSS",
@@ -1327,7 +1328,7 @@ static const char* const JSON_transcode_morale[] = {
 	"SCREAM"
 };
 
-static const char* const JSON_transcode_pl_flags[] = {
+static constexpr const char* JSON_transcode_pl_flags[] = {
 	"FLEET",
 	"PARKOUR",
 	"QUICK",
@@ -1584,6 +1585,8 @@ void player::reset(const Badge<game>& auth)
  blocks_left = 1;
 // Didn't just pick something up
  last_item = itype_id(itm_null);
+// Item charges and contents change in ways the inventory stamp cannot see; recount once a turn
+ invalidate(DERIVED_CARRIED);
 // Bionic buffs
  if (has_active_bionic(bio_hydraulics)) str_cur += 20;
  if (has_bionic(bio_eye_enhancer)) per_cur += 2;
@@ -2885,6 +2888,7 @@ void player::toggle_trait(int flag)
 {
  my_traits[flag] = !my_traits[flag];
  my_mutations[flag] = !my_mutations[flag];
+ invalidate(DERIVED_SIGHT);
 }
 
 const char* player::interpret_trait(const std::pair<pl_flag, const char*>* origin, ptrdiff_t ub) const
@@ -2896,16 +2900,76 @@ const char* player::interpret_trait(const std::pair<pl_flag, const char*>* origi
 }
 
 
+bool player::cross_check = false;
+size_t player::cross_check_failures = 0;
+
+void player::_rebuild(derived_stats& dest, unsigned char what) const
+{
+ if (DERIVED_BIONICS & what) {
+  dest.bionics.reset();
+  dest.active_bionics.reset();
+  for (const auto& bio : my_bionics) {
+   dest.bionics.set(bio.id);
+   if (bio.powered) dest.active_bionics.set(bio.id);
+  }
+ }
+ if (DERIVED_DISEASES & what) {
+  dest.diseases.reset();
+  for (decltype(auto) ill : illness) dest.diseases.set(ill.type);
+ }
+ if (DERIVED_ADDICTIONS & what) {
+  dest.addictions.reset();
+  for (const auto& a : addictions) if (a.intensity >= MIN_ADDICTION_LEVEL) dest.addictions.set(a.type);
+ }
+ if (DERIVED_CARRIED & what) {
+  dest.weight_carried = 0;
+  dest.volume_carried = 0;
+  dest.active_items.clear();
+  for (const auto& it : worn) dest.weight_carried += it.weight();
+  for (size_t i = 0; i < inv.size(); i++) {
+   int j = -1;
+   for (const auto& it : inv.stack_at(i)) {
+    ++j;
+    dest.weight_carried += it.weight();
+    dest.volume_carried += it.volume();
+    if (it.active || it.is_artifact_tool()) dest.active_items.push_back(std::pair(int(i), j));	// cf. pc::use_active
+   }
+  }
+  dest.inv_version = inv.version();
+  dest.worn_count = worn.size();
+ }
+}
+
+const player::derived_stats& player::derived(unsigned char need) const
+{
+ if ((DERIVED_CARRIED & need) && (inv.version() != _derived.inv_version || worn.size() != _derived.worn_count)) invalidate(DERIVED_CARRIED);
+ if (const unsigned char stale = _derived.stale & need & ~DERIVED_SIGHT) {
+  _rebuild(_derived, stale);
+  _derived.stale &= ~stale;
+ } else if (cross_check) {
+  derived_stats fresh;
+  _rebuild(fresh, need);
+  const bool ok = (!(DERIVED_BIONICS & need) || (fresh.bionics == _derived.bionics && fresh.active_bionics == _derived.active_bionics))
+               && (!(DERIVED_DISEASES & need) || fresh.diseases == _derived.diseases)
+               && (!(DERIVED_ADDICTIONS & need) || fresh.addictions == _derived.addictions)
+               && (!(DERIVED_CARRIED & need) || (fresh.weight_carried == _derived.weight_carried && fresh.volume_carried == _derived.volume_carried && fresh.active_items == _derived.active_items));
+  if (!ok) {
+   debuglog("%s: stale derived stats (%d)", name.c_str(), int(need));
+   cross_check_failures++;
+   _rebuild(_derived, need & ~DERIVED_SIGHT);
+  }
+ }
+ return _derived;
+}
+
 bool player::has_bionic(bionic_id b) const
 {
- for (const auto& bionic : my_bionics) if (bionic.id == b) return true;
- return false;
+ return derived(DERIVED_BIONICS).bionics[b];
 }
 
 bool player::has_active_bionic(bionic_id b) const
 {
- for (const auto& bionic : my_bionics) if (bionic.id == b) return bionic.powered;
- return false;
+ return derived(DERIVED_BIONICS).active_bionics[b];
 }
 
 void player::add_bionic(bionic_id b)
@@ -2914,6 +2978,7 @@ void player::add_bionic(bionic_id b)
 
  char newinv = my_bionics.empty() ? 'a' : my_bionics.back().invlet+1;
  my_bionics.push_back(bionic(b, newinv));
+ invalidate(DERIVED_BIONICS);
 }
 
 void player::charge_power(int amount)
@@ -2961,7 +3026,30 @@ unsigned int player::sight_range(int light_level) const
 
 /// includes aerial vibrations, not just ground vibrations -- flying creatures noticed as well
 unsigned int player::seismic_range() const { return has_trait(PF_ANTENNAE) ? 3 : 0; }
-unsigned int player::sight_range() const { return sight_range(game::active()->light_level(GPSpos)); }
+// light level is the expensive part; it holds for the turn, unless what we carry or wield changes
+unsigned int player::sight_range() const
+{
+ const int turn = int(messages.turn);
+ derived(DERIVED_CARRIED);	// stales sight, if what we carry changed
+ if ((DERIVED_SIGHT & _derived.stale) || turn != _derived.sight_turn || GPSpos != _derived.sight_from || underwater != _derived.sight_underwater
+     || weapon.type != _derived.sight_weapon || weapon.active != _derived.sight_weapon_active) {
+  _derived.sight = sight_range(game::active()->light_level(GPSpos));
+  _derived.sight_turn = turn;
+  _derived.sight_from = GPSpos;
+  _derived.sight_underwater = underwater;
+  _derived.sight_weapon = weapon.type;
+  _derived.sight_weapon_active = weapon.active;
+  _derived.stale &= ~DERIVED_SIGHT;
+ } else if (cross_check) {
+  const auto fresh = sight_range(game::active()->light_level(GPSpos));
+  if (fresh != _derived.sight) {
+   debuglog("%s: stale sight range %d, should be %d", name.c_str(), int(_derived.sight), int(fresh));
+   cross_check_failures++;
+   _derived.sight = fresh;
+  }
+ }
+ return _derived.sight;
+}
 
 unsigned int player::overmap_sight_range() const
 {
@@ -3598,6 +3686,7 @@ void player::add_disease(dis_type type, int duration, int intensity, int max_int
 	messages.add(describe(type));
  }
  illness.emplace_back(type, duration, intensity);
+ invalidate(DERIVED_DISEASES);
 }
 
 bool player::rem_disease(dis_type type)
@@ -3610,6 +3699,7 @@ bool player::rem_disease(dis_type type)
             ret = true;
         }
     }
+    if (ret) invalidate(DERIVED_DISEASES);
     return ret;
 }
 
@@ -3625,10 +3715,12 @@ bool player::rem_disease(std::function<bool(disease&)> op)
             ret = true;
         }
     }
+    if (ret) invalidate(DERIVED_DISEASES);
     return ret;
 }
 
 bool player::do_foreach(std::function<bool(disease&)> op) {
+    invalidate(DERIVED_DISEASES);   // op has write access
     for (decltype(auto) ill : illness) if (op(ill)) return true;
     return false;
 }
@@ -3640,18 +3732,19 @@ bool player::do_foreach(std::function<bool(const disease&)> op) const {
 
 bool player::has_disease(dis_type type) const
 {
- for (decltype(auto) ill : illness) if (ill.type == type) return true;
- return false;
+ return derived(DERIVED_DISEASES).diseases[type];
 }
 
 int player::disease_level(dis_type type) const
 {
+ if (!has_disease(type)) return 0;
  for (decltype(auto) ill : illness) if (ill.type == type) return ill.duration;
  return 0;
 }
 
 int player::disease_intensity(dis_type type) const
 {
+ if (!has_disease(type)) return 0;
  for (decltype(auto) ill : illness) if (ill.type == type) return ill.intensity;
  return 0;
 }
@@ -3671,6 +3764,7 @@ bool player::rude_awakening()
 void player::add_addiction(add_type type, int strength)
 {
  if (type == ADD_NULL) return;
+ invalidate(DERIVED_ADDICTIONS);
  int timer = HOURS(2);  // \todo make this substance-dependent?
  if (has_trait(PF_ADDICTIVE)) {
   rational_scale<3,2>(strength);
@@ -3690,8 +3784,7 @@ void player::add_addiction(add_type type, int strength)
 
 bool player::has_addiction(add_type type) const
 {
- for(const auto& a : addictions) if (a.type == type && a.intensity >= MIN_ADDICTION_LEVEL) return true;
- return false;
+ return derived(DERIVED_ADDICTIONS).addictions[type];
 }
 
 #if DEAD_FUNC
@@ -3746,12 +3839,16 @@ void player::suffer(game *g)
  while (0 <= --_i) {
      decltype(auto) ill = illness[_i];
      if (MIN_DISEASE_AGE > --ill.duration) ill.duration = MIN_DISEASE_AGE; // Cap permanent disease age
-     else if (0 == ill.duration) EraseAt(illness, _i);
+     else if (0 == ill.duration) {
+         EraseAt(illness, _i);
+         invalidate(DERIVED_DISEASES);
+     }
  }
  if (!has_disease(DI_SLEEP)) {
   const int timer = has_trait(PF_ADDICTIVE) ? -HOURS(6)-MINUTES(40) : -HOURS(6);
   // \todo work out why addiction processing only happens when awake
   _i = addictions.size();
+  if (0 < _i) invalidate(DERIVED_ADDICTIONS);
   while (0 <= --_i) {
       decltype(auto) addict = addictions[_i];
       if (0 >= addict.sated && MIN_ADDICTION_LEVEL <= addict.intensity) addict_effect(*this, addict);
@@ -4037,17 +4134,26 @@ void player::fling(int dir, int flvel)
     tileray tdir(dir);
     std::string sname = grammar::capitalize(subject())+" "+to_be();
 
+    const animation anim(g->w_terrain, animation::FLIGHT);
     int range = flvel / 10;
     decltype(auto) loc = GPSpos;
     while (range > 0) {
         tdir.advance();
+        const auto from = GPSpos;
         loc = GPSpos + point(tdir.dx(), tdir.dy());
         if (!flung(flvel, loc)) break;
         set_screenpos(loc);
         range--;
         steps++;
-        timespec ts = { 0, 50000000 };   // Timespec for the animation
-        nanosleep(&ts, nullptr);
+        if (!anim) continue;
+        if (is_u) {	// the view moves with us
+            g->draw();
+            anim.hold();
+        } else if (g->u.see(loc)) {
+            if (g->u.see(from)) map::drawsq(g->w_terrain, g->u, from, false, true);
+            if (auto mob = g->mob_at(loc)) std::visit(draw_mob(g->w_terrain, g->u.pos, false), *mob);
+            anim.frame();
+        }
     }
 
     if (!is<swimmable>(loc.ter())) {
@@ -4079,22 +4185,12 @@ void player::fling(int dir, int flvel)
 
 int player::weight_carried() const
 {
- int ret = 0;
- ret += weapon.weight();
- for (const auto& it : worn) ret += it.weight();
- for (size_t i = 0; i < inv.size(); i++) {
-  for (const auto& it : inv.stack_at(i)) ret += it.weight();
- }
- return ret;
+ return weapon.weight() + derived(DERIVED_CARRIED).weight_carried;
 }
 
 int player::volume_carried() const
 {
- int ret = 0;
- for (size_t i = 0; i < inv.size(); i++) {
-  for (const auto& it : inv.stack_at(i)) ret += it.volume();
- }
- return ret;
+ return derived(DERIVED_CARRIED).volume_carried;
 }
 
 // internal unit is 4 oz (divide by 4 to get pounds)
@@ -4205,6 +4301,7 @@ void player::sort_inv()
 void player::i_add(item&& it)
 {
  last_item = itype_id(it.type->id);
+ invalidate(DERIVED_CARRIED);
  if (it.is_food() || it.is_ammo() || it.is_gun()  || it.is_armor() || 
      it.is_book() || it.is_tool() || it.is_weap() || it.is_food_container())
   inv_sorted = false;
@@ -4232,8 +4329,9 @@ void player::i_add(item&& it)
 bool player::has_active_item(itype_id id) const
 {
  if (weapon.type->id == id && weapon.active) return true;
- for (size_t i = 0; i < inv.size(); i++) {
-  if (inv[i].type->id == id && inv[i].active) return true;
+ for (const auto& pos : derived(DERIVED_CARRIED).active_items) {
+  const item& it = inv.stack_at(pos.first)[pos.second];
+  if (it.type->id == id && it.active) return true;
  }
  return false;
 }
@@ -4242,8 +4340,9 @@ int player::active_item_charges(itype_id id) const
 {
  int max = 0;
  if (weapon.type->id == id && weapon.active) max = weapon.charges;
- for (size_t i = 0; i < inv.size(); i++) {
-     for (const item& it : inv.stack_at(i)) if (it.type->id == id && it.active && it.charges > max) max = it.charges;
+ for (const auto& pos : derived(DERIVED_CARRIED).active_items) {
+  const item& it = inv.stack_at(pos.first)[pos.second];
+  if (it.type->id == id && it.active && it.charges > max) max = it.charges;
  }
  return max;
 }
@@ -4303,11 +4402,19 @@ void player::process_active_items(game *g)
     // ignore code 1: ok for weapon to be the null item
     }
 
- for (size_t i = 0; i < inv.size(); i++) {
-  decltype(auto) _inv = inv.stack_at(i);
-  int j = _inv.size();
-  while(0 < j) {
-      item* tmp_it = &(_inv[--j]);
+ // only the items use_active has work for; stacks in order, each from the top down
+ const auto todo = derived(DERIVED_CARRIED).active_items;	// copy: using the inventory makes the original stale
+ int gone = 0;	// stacks destroyed so far
+ for (size_t first = 0; first < todo.size(); ) {
+  size_t last = first;
+  while (last < todo.size() && todo[last].first == todo[first].first) last++;
+  const int i = todo[first].first - gone;
+  size_t k = last;
+  while (first < k && i < inv.size()) {
+      const int j = todo[--k].second;
+      decltype(auto) _inv = inv.stack_at(i);
+      if (j >= _inv.size()) continue;
+      item* tmp_it = &(_inv[j]);
       switch (int code = use_active(*tmp_it))
       {
       case -2:
@@ -4317,12 +4424,13 @@ void player::process_active_items(game *g)
       case 1:  // null item shall not survive in inventory
           if (1 == _inv.size()) {
               inv.destroy_stack(i); // references die
-              i--;
-              j = 0;
+              gone++;
+              k = first;
           } else EraseAt(_inv, j);
           break;
       }
   }
+  first = last;
  }
  for (auto& it : worn) {
   if (it.is_artifact()) g->process_artifact(&it, this);
@@ -5029,6 +5137,7 @@ bool player::wear_item(const item& to_wear)
  moves -= 7 * (mobile::mp_turn / 2); // \todo? Make this variable
  last_item = itype_id(to_wear.type->id);
  worn.push_back(to_wear);
+ invalidate(DERIVED_CARRIED);
  if (!is_npc()) {
      for (body_part i = bp_head; i < num_bp; i = body_part(i + 1)) {
          if (armor->covers & mfb(i) && encumb(i) >= 4)
@@ -5050,6 +5159,7 @@ int player::can_take_off_armor(const item& it) const
 
 bool player::take_off(int i)
 {
+    invalidate(DERIVED_CARRIED);
     auto& it = worn[i];
     switch (const auto code = can_take_off_armor(it))
     {
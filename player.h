@@ -10,10 +10,12 @@
 #include "bodypart.h"
 #include "pldata.h"
 #include "zero.h"
+#include <bitset>
 #include <functional>
 
 enum art_effect_passive;
 enum craft_cat : int;
+class crafting_stock;
 class game;
 struct mission;
 class monster;
@@ -108,6 +110,20 @@ public:
  // \todo once MSVC++ has std::ranges support, consider cutting over to that
  const char* interpret_trait(const std::pair<pl_flag, const char*>* origin, ptrdiff_t ub) const;
 
+ // Derived stats are cached; whatever changes what they are derived from, calls invalidate.
+ // Turn-by-turn changes (item charges, light) are covered by reset and by keys checked on each read.
+ enum derived_stat : unsigned char {
+	 DERIVED_BIONICS = 1,
+	 DERIVED_DISEASES = 2,
+	 DERIVED_ADDICTIONS = 4,
+	 DERIVED_CARRIED = 8,
+	 DERIVED_SIGHT = 16,	// depends on all the others
+	 DERIVED_ALL = 31
+ };
+ void invalidate(unsigned char what = DERIVED_ALL) const { _derived.stale |= what | DERIVED_SIGHT; }
+ static bool cross_check;	// debug: every cached read is recomputed and compared
+ static size_t cross_check_failures;
+
  // bionics
  bool has_bionic(bionic_id b) const;
  bool has_active_bionic(bionic_id b) const;
@@ -335,8 +351,8 @@ public:
 
 // crafting.cpp
  void make_craft(const recipe* making);
- void pick_recipes(std::vector<const recipe*>& current,
-     std::vector<bool>& available, craft_cat tab);
+ void pick_recipes(const crafting_stock& crafting_inv, std::vector<const recipe*>& current,
+     std::vector<bool>& available, craft_cat tab) const;
 
 // construction.cpp
  void complete_construction();
@@ -467,6 +483,32 @@ private:
  int blocks_left;
  std::vector <disease> illness;
 
+ struct derived_stats {
+	 std::bitset<max_bio> bionics;	// installed
+	 std::bitset<max_bio> active_bionics;
+	 std::bitset<NUM_DISEASES> diseases;
+	 std::bitset<NUM_ADDICTIONS> addictions;	// at MIN_ADDICTION_LEVEL or more
+	 int weight_carried;	// worn and inventory; the weapon is cheap to add
+	 int volume_carried;
+	 std::vector<std::pair<int, int> > active_items;	// inventory (stack, index) that use_active has work for
+	 unsigned long long inv_version;	// keys for weight/volume/active_items
+	 size_t worn_count;
+	 int sight_turn;	// keys for sight
+	 GPS_loc sight_from;
+	 bool sight_underwater;
+	 const itype* sight_weapon;	// a wielded light counts toward light_level
+	 bool sight_weapon_active;
+	 unsigned int sight;
+	 unsigned char stale;	// derived_stat flags
+
+	 derived_stats() noexcept : weight_carried(0), volume_carried(0), inv_version(0), worn_count(0), sight_turn(-1), sight_from(_ref<GPS_loc>::invalid),
+		 sight_underwater(false), sight_weapon(nullptr), sight_weapon_active(false), sight(0), stale(DERIVED_ALL) {}
+ };
+ mutable derived_stats _derived;
+
+ const derived_stats& derived(unsigned char need) const;	// rebuilds what is stale
+ void _rebuild(derived_stats& dest, unsigned char what) const;
+
  void _set_screenpos() override { if (auto pt = screen_pos()) pos = *pt; }
  bool handle_knockback_into_impassable(const GPS_loc& dest) override;
  virtual void consume(item& food) = 0;
@@ -492,6 +534,4 @@ private:
  void absorb(body_part bp, int &dam, int &cut);	// \todo V 0.2.1 enable for NPCs?
 };
 
-inventory crafting_inventory(const player& u);
-
 #endif
@@ -2,7 +2,7 @@
 
 #include <sstream>
 
-static const char* const JSON_transcode_addiction[] = {
+static constexpr const char* JSON_transcode_addiction[] = {
     "CAFFEINE",
     "ALCOHOL",
     "SLEEP",
@@ -44,6 +44,7 @@ enum dis_type {
 // NPC-only
  DI_CATCH_UP
 };
+static constexpr const auto NUM_DISEASES = DI_CATCH_UP + 1;
 
 enum add_type {
  ADD_NULL,
@@ -0,0 +1,143 @@
+#include "profiler.hpp"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string.h>
+
+profiler& profiler::get()
+{
+	static profiler ooao;
+	return ooao;
+}
+
+const char* profiler::name(zone z)
+{
+	static const char* const names[NUM_ZONES] = {
+		"turn",
+		"world",
+		"autosave",
+		"scent",
+		"vehmove",
+		"fields",
+		"map items",
+		"monmove",
+		"stairs",
+		"om npcs",
+		"u items",
+		"suffer",
+		"route",
+		"sees",
+		"monster plan",
+		"npc move"
+	};
+	return (0 <= z && NUM_ZONES > z) ? names[z] : "?";
+}
+
+unsigned long long profiler::histogram::percentile(double p) const
+{
+	if (!calls) return 0;
+	const unsigned long long want = (unsigned long long)(p * calls + 0.5);
+	unsigned long long seen = 0;
+	for (int i = 0; i < buckets; i++) {
+		seen += count[i];
+		if (seen >= want && 0 < seen) {
+			const unsigned long long ub = 2ULL << i;
+			return ub < max_ns ? ub : max_ns;
+		}
+	}
+	return max_ns;
+}
+
+void profiler::record(zone z, long long ns, unsigned weight)
+{
+	if (0 > ns) ns = 0;
+	const unsigned long long elapsed = ns;
+	auto& dest = _zones[z];
+	dest.calls++;	// a sample's untimed calls were counted as they were skipped
+	dest.total_ns += elapsed * weight;
+	if (dest.max_ns < elapsed) dest.max_ns = elapsed;
+	int bucket = 0;
+	for (unsigned long long x = elapsed >> 1; x && buckets - 1 > bucket; x >>= 1) bucket++;
+	dest.count[bucket] += weight;
+	_this_turn[z] += elapsed * weight;
+}
+
+void profiler::end_turn(int turn)
+{
+	if (!enabled) return;
+	if (_worst[TURN] < _this_turn[TURN]) {
+		memcpy(_worst, _this_turn, sizeof(_worst));
+		_worst_turn = turn;
+	}
+	memset(_this_turn, 0, sizeof(_this_turn));
+}
+
+void profiler::reset()
+{
+	memset(_zones, 0, sizeof(_zones));
+	memset(_this_turn, 0, sizeof(_this_turn));
+	memset(_worst, 0, sizeof(_worst));
+	memset(_skip, 0, sizeof(_skip));
+	_worst_turn = -1;
+}
+
+std::string profiler::report() const
+{
+	std::ostringstream ret;
+	ret << std::fixed << std::setprecision(1);
+	ret << "Turn-time profile (" << (enabled ? "recording" : "stopped") << "), microseconds\n";
+	ret << std::left << std::setw(13) << "zone" << std::right << std::setw(10) << "calls" << std::setw(10) << "mean"
+		<< std::setw(10) << "p50" << std::setw(10) << "p95" << std::setw(10) << "max" << std::setw(12) << "total ms" << "\n";
+	for (int i = 0; i < NUM_ZONES; i++) {
+		const auto& x = _zones[i];
+		if (!x.calls) continue;
+		ret << std::left << std::setw(13) << name(zone(i)) << std::right << std::setw(10) << x.calls << std::setw(10) << x.mean_ns() / 1e3
+			<< std::setw(10) << x.percentile(0.5) / 1e3 << std::setw(10) << x.percentile(0.95) / 1e3 << std::setw(10) << x.max_ns / 1e3
+			<< std::setw(12) << x.total_ns / 1e6 << "\n";
+	}
+	if (0 <= _worst_turn) {
+		// The phases of TURN, then what is left of it; world and the inner zones are outside that sum.
+		unsigned long long phases = 0;
+		for (int i = SCENT; i < ROUTE; i++) phases += _worst[i];
+		std::ostringstream line;
+		line << std::fixed << std::setprecision(1) << "Worst turn " << _worst_turn << ": " << _worst[TURN] / 1e3 << " us =";
+		const auto item = [&](const char* label, unsigned long long ns) {
+			std::ostringstream dest;
+			dest << std::fixed << std::setprecision(1) << " " << label << " " << ns / 1e3;
+			if (70 < line.tellp() + dest.tellp()) {	// popups do not wrap
+				ret << "\n" << line.str();
+				line.str(std::string());
+				line << " ";
+			}
+			line << dest.str();
+		};
+		for (int i = SCENT; i < ROUTE; i++) if (_worst[i]) item(name(zone(i)), _worst[i]);
+		item("other", _worst[TURN] > phases ? _worst[TURN] - phases : 0);
+		ret << "\n" << line.str() << "\n";
+		line.str(std::string());
+		line << "Also:";
+		for (int i = WORLD; i < NUM_ZONES; i++) {
+			if (SCENT == i) i = ROUTE;
+			if (_worst[i]) item(name(zone(i)), _worst[i]);
+		}
+		ret << line.str() << "\n";
+	}
+	return ret.str();
+}
+
+bool profiler::write_csv(const std::string& dest) const
+{
+	std::ofstream fout(dest.c_str());
+	if (!fout.is_open()) return false;
+	fout << "zone,calls,total_ns,mean_ns,p50_ns,p95_ns,p99_ns,max_ns,worst_turn_ns";
+	for (int i = 0; i < buckets; i++) fout << ",lt_" << (2ULL << i) << "ns";
+	fout << "\n";
+	for (int i = 0; i < NUM_ZONES; i++) {
+		const auto& x = _zones[i];
+		fout << name(zone(i)) << "," << x.calls << "," << x.total_ns << "," << (unsigned long long)(x.mean_ns() + 0.5) << ","
+			<< x.percentile(0.5) << "," << x.percentile(0.95) << "," << x.percentile(0.99) << "," << x.max_ns << "," << _worst[i];
+		for (int j = 0; j < buckets; j++) fout << "," << x.count[j];
+		fout << "\n";
+	}
+	return bool(fout);
+}
@@ -0,0 +1,138 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP 1
+
+#include <chrono>
+#include <string>
+
+// singleton
+// Turn-time profile: wall-clock time in the phases of game::do_turn after the player's input, and in the inner calls
+// that dominate them.  Off until enabled from the debug menu; disabled, a scope costs a test of one flag.
+// Each zone keeps a log2 histogram of nanoseconds per call, so percentiles are estimates (to within a factor of two).
+// Nested zones are not subtracted from their parents: route and sees are usually inside monmove.
+// The inner zones (route onward) only record while world or turn is open, so drawing and input are not charged to them.
+// sees is called tens of thousands of times a turn: every call is counted, but only one in sees_sample is timed.
+class profiler
+{
+public:
+	enum zone {
+		TURN = 0,	// do_turn after input, through weather effects
+		WORLD,	// do_turn before input: events, missions, weather, spawns, activity
+		AUTOSAVE,
+		SCENT,
+		VEHMOVE,
+		FIELDS,
+		MAP_ITEMS,
+		MONMOVE,
+		STAIRS,
+		OM_NPCS,
+		U_ITEMS,
+		SUFFER,
+		ROUTE,	// map::route
+		SEES,	// map::sees
+		MON_PLAN,	// monster::plan
+		NPC_MOVE,	// npc::move
+		NUM_ZONES
+	};
+	static constexpr const int buckets = 40;	// bucket i: [2^i, 2^(i+1)) ns; bucket 0 also takes 0
+	static constexpr const unsigned sees_sample = 64;
+
+	struct histogram {
+		unsigned long long calls;
+		unsigned long long total_ns;
+		unsigned long long max_ns;
+		unsigned long long count[buckets];
+
+		unsigned long long percentile(double p) const;	// upper bound of the bucket holding it
+		double mean_ns() const { return calls ? double(total_ns) / calls : 0.0; }
+	};
+
+	class scope {
+		const zone z;
+		const bool live;
+		std::chrono::steady_clock::time_point start;
+	public:
+		explicit scope(zone z) : z(z), live(get().open(z)) {
+			if (live) start = std::chrono::steady_clock::now();
+		}
+		scope(const scope& src) = delete;
+		scope(scope&& src) = delete;
+		~scope() {
+			if (live) get().close(z, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+		}
+		scope& operator=(const scope& src) = delete;
+		scope& operator=(scope&& src) = delete;
+	};
+
+	// for zones too hot to time every call: counts each call, times one in every Sample and weights it by Sample
+	template<zone Z, unsigned Sample>
+	class sampled_scope {
+		bool live;
+		std::chrono::steady_clock::time_point start;
+	public:
+		sampled_scope() : live(false) {
+			auto& prof = get();
+			if (!prof.enabled || !prof._phase) return;
+			if (prof._skip[Z]) {
+				prof._skip[Z]--;
+				prof._zones[Z].calls++;
+				return;
+			}
+			prof._skip[Z] = Sample - 1;
+			live = true;
+			start = std::chrono::steady_clock::now();
+		}
+		sampled_scope(const sampled_scope& src) = delete;
+		sampled_scope(sampled_scope&& src) = delete;
+		~sampled_scope() {
+			if (live) get().record(Z, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(), Sample);
+		}
+		sampled_scope& operator=(const sampled_scope& src) = delete;
+		sampled_scope& operator=(sampled_scope&& src) = delete;
+	};
+
+	bool enabled;
+
+private:
+	histogram _zones[NUM_ZONES];
+	unsigned long long _this_turn[NUM_ZONES];	// accumulated since end_turn
+	unsigned long long _worst[NUM_ZONES];	// _this_turn, for the turn with the longest TURN
+	int _worst_turn;
+	unsigned _phase;	// world and turn scopes open
+	unsigned _skip[NUM_ZONES];	// calls left before the next timed sample
+
+	static constexpr bool is_phase(zone z) { return TURN == z || WORLD == z; }
+	static constexpr bool is_inner(zone z) { return ROUTE <= z; }
+
+	profiler() : enabled(false), _phase(0) { reset(); }
+	~profiler() = default;
+	profiler(const profiler& src) = delete;
+	profiler(profiler&& src) = delete;
+	profiler& operator=(const profiler& src) = delete;
+	profiler& operator=(profiler&& src) = delete;
+
+	bool open(zone z) {
+		if (!enabled || (is_inner(z) && !_phase)) return false;
+		if (is_phase(z)) _phase++;
+		return true;
+	}
+	void close(zone z, long long ns) {
+		if (is_phase(z)) _phase--;
+		record(z, ns, 1);
+	}
+	void record(zone z, long long ns, unsigned weight);	// weight: calls this one stands for
+public:
+	static profiler& get();
+	static const char* name(zone z);
+
+	void end_turn(int turn);	// closes the per-turn breakdown
+	void reset();
+
+	const histogram& operator[](zone z) const { return _zones[z]; }
+	const unsigned long long* worst() const { return _worst; }	// indexed by zone
+	int worst_turn() const { return _worst_turn; }
+
+	std::string report() const;	// for a popup
+	bool write_csv(const std::string& dest) const;
+};
+
+#endif
@@ -8,7 +8,7 @@
 #include "options.h"
 #include "mondeath.h"
 #include "gui.hpp"
-#include "posix_time.h"
+#include "animation.hpp"
 #include "recent_msg.h"
 
 #include <math.h>
@@ -301,8 +301,7 @@ void game::fire(player& p, std::vector<GPS_loc>& trajectory, bool burst)
 
     // Make a sound at our location - Zombies will chase it
     make_gun_sound_effect(this, p, burst);
-    // Set up a timespec for use in the nanosleep function below
-    timespec ts = { 0,  BULLET_SPEED };
+    const animation anim(w_terrain, animation::BULLET);
 
     bool missed = false;
     for (int curshot = 0; curshot < num_shots; curshot++) {
@@ -391,17 +390,18 @@ retry_new_target:
 
         int dam = p.weapon.gun_damage();
         for (int i = 0; i < trajectory.size() && (dam > 0 || (flags & IF_AMMO_FLAME)); i++) {
-            if (i > 0)
-                map::drawsq(w_terrain, u, trajectory[i - 1], false, true);
-            // Drawing the bullet uses player u, and not player p, because it's drawn
-            // relative to YOUR position, which may not be the gunman's position.
-            if (u.see(trajectory[i])) {
-                if (const auto pos = toScreen(trajectory[i])) {
-                    char bullet = (flags & mfb(IF_AMMO_FLAME)) ? '#' : '*';
-                    const point pt(*pos + point(VIEW_CENTER) - u.pos);
-                    mvwputch(w_terrain, pt.y, pt.x, c_red, bullet);
-                    wrefresh(w_terrain);
-                    if (&p == &u) nanosleep(&ts, nullptr);
+            if (anim) {
+                if (i > 0)
+                    map::drawsq(w_terrain, u, trajectory[i - 1], false, true);
+                // Drawing the bullet uses player u, and not player p, because it's drawn
+                // relative to YOUR position, which may not be the gunman's position.
+                if (u.see(trajectory[i])) {
+                    if (const auto pos = toScreen(trajectory[i])) {
+                        char bullet = (flags & mfb(IF_AMMO_FLAME)) ? '#' : '*';
+                        const point pt(*pos + point(VIEW_CENTER) - u.pos);
+                        mvwputch(w_terrain, pt.y, pt.x, c_red, bullet);
+                        if (&p == &u) anim.frame();   // others' fire shows at the next redraw
+                    }
                 }
             }
 
@@ -3,6 +3,11 @@
 #include "om_cache.hpp"
 #include "mapbuffer.h"
 #include "recent_msg.h"
+#include "Zaimoni.STL/Logging.h"
+
+#include <algorithm>
+#include <climits>
+#include <string.h>
 
 int& reality_bubble::scent(int x, int y)
 {
@@ -10,6 +15,61 @@ int& reality_bubble::scent(int x, int y)
 	return grscent[x][y];
 }
 
+void reality_bubble::diffuse_scent(const point& center)
+{
+	static constexpr const int ub = SEE * MAPSIZE;
+	// keep the 3x3 stencil inside grscent even if center is near the edge
+	const point tl(std::clamp(center.x - scent_radius, 1, ub - 1 - scent_span), std::clamp(center.y - scent_radius, 1, ub - 1 - scent_span));
+
+	point delta;
+	for (delta.x = 0; delta.x < scent_span; delta.x++) {
+		for (delta.y = 0; delta.y < scent_span; delta.y++) {
+			const point pt(tl + delta);
+			_scent_open[delta.x][delta.y] = 0 != m.move_cost(pt) || m.has_flag(bashable, pt);
+			const auto& fd = m.field_at(pt);
+			_scent_floor[delta.x][delta.y] = (fd.type == fd_slime) ? 10 * fd.density : INT_MIN;
+		}
+	}
+
+	// Each tile averages itself and those neighbors at least as strong as it is.  The accumulation pass is
+	// branch-free over contiguous rows so that it vectorizes; the division and the rare cases come after.
+	int sum[scent_span];
+	int used[scent_span];
+	for (delta.x = 0; delta.x < scent_span; delta.x++) {
+		const int x = tl.x + delta.x;
+		const int* const rows[3] = { grscent[x - 1] + tl.y, grscent[x] + tl.y, grscent[x + 1] + tl.y };
+		for (int dy = 0; dy < scent_span; dy++) {
+			const int origin = rows[1][dy];
+			int total = 0;
+			int n = 0;
+			for (int i = 0; i < 3; i++) {
+				for (int j = -1; j <= 1; j++) {
+					const int src = rows[i][dy + j];
+					const int take = (origin <= src);
+					total += take * src;
+					n += take;
+				}
+			}
+			sum[dy] = total;
+			used[dy] = n;
+		}
+		for (int dy = 0; dy < scent_span; dy++) {
+			int& dest = _scent_next[delta.x][dy];
+			if (!_scent_open[delta.x][dy]) {
+				dest = 0;
+				continue;
+			}
+			dest = sum[dy] / (used[dy] + 1);
+			clamp_lb(dest, _scent_floor[delta.x][dy]);
+			if (dest > 10000) {
+				debuglog("Wacky scent at %d, %d (%d)", x, tl.y + dy, dest);
+				dest = 0; // Scent should never be higher
+			}
+		}
+	}
+	for (delta.x = 0; delta.x < scent_span; delta.x++) memcpy(grscent[tl.x + delta.x] + tl.y, _scent_next[delta.x], sizeof(_scent_next[delta.x]));
+}
+
 // cf map::loadn
 GPS_loc reality_bubble::toGPS(point screen_pos) const	// \todo overflow checking
 {
@@ -28,6 +28,13 @@ public:
 protected:
 	int grscent[SEEX * MAPSIZE][SEEY * MAPSIZE];	// The scent map
 
+private:
+	static constexpr const int scent_radius = 18;	// diffuse_scent updates a square this far out from its center
+	static constexpr const int scent_span = 2 * scent_radius + 1;
+	int _scent_next[scent_span][scent_span];	// back buffer for diffuse_scent
+	int _scent_floor[scent_span][scent_span];	// slime keeps scent at least this high; INT_MIN where there is none
+	bool _scent_open[scent_span][scent_span];	// scent only spreads where something could follow it
+
 public:
 	  // but game::update_map thinks legal values are 0..2*OMAPX/Y
 	  // lev.z is almost always cur_om.pos.z (possibly should be explicitly enforced as map loading responds to cur_om.pos.z)
@@ -39,6 +46,7 @@ public:
 	int scent(int x, int y) const { return const_cast<reality_bubble*>(this)->scent(x, y); };	// consider optimized implementation
 	int scent(const point& pt) const { return const_cast<reality_bubble*>(this)->scent(pt.x, pt.y); };
 	void clear_scents() { memset(grscent, 0, sizeof(grscent)); }
+	void diffuse_scent(const point& center);	// one turn of scent spreading around center
 
 	// coordinate juggling
 	GPS_loc toGPS(point screen_pos) const;
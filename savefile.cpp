@@ -0,0 +1,242 @@
+#include "savefile.hpp"
+#include "ios_file.h"
+#include "output.h"
+#include "options.h"
+#include "savepack.hpp"
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string_view>
+#include <stdio.h>
+#include <string.h>
+
+savefile& savefile::get()
+{
+	static savefile ooao;
+	return ooao;
+}
+
+savefile::savefile()
+: _stop(false), _stats{}
+{
+	_writer = std::thread(&savefile::run, this);
+}
+
+savefile::~savefile()
+{
+	{
+	std::unique_lock<std::mutex> guard(_lock);
+	_stop = true;
+	}
+	_changed.notify_all();
+	_writer.join();	// finishes the queue first
+}
+
+void savefile::write(const std::string& dest, const std::string& tmp, std::string&& head, cataclysm::JSON&& body, const std::string& backup)
+{
+	enqueue(job{ dest, tmp, backup, std::move(head), std::move(body), false, (bool)option_table::get()[OPT_COMPRESS_SAVES] });
+}
+
+void savefile::write_binary(const std::string& dest, std::string&& head, cataclysm::JSON&& body)
+{
+	enqueue(job{ dest, dest + ".tmp", std::string(), std::move(head), std::move(body), true, (bool)option_table::get()[OPT_COMPRESS_SAVES] });
+}
+
+void savefile::write_plain(const std::string& dest, std::string&& data)
+{
+	enqueue(job{ dest, dest + ".tmp", std::string(), std::move(data), cataclysm::JSON(), false, false });
+}
+
+void savefile::remove(const std::string& dest)
+{
+	job doomed{ dest, dest + ".tmp", std::string(), std::string(), cataclysm::JSON(), false, false };
+	doomed.erase = true;
+	enqueue(std::move(doomed));
+}
+
+void savefile::enqueue(job&& src)
+{
+	std::unique_lock<std::mutex> guard(_lock);
+	report(guard);
+	if (queue_limit <= _queue.size()) {
+		_stats.stalls++;
+		_changed.wait(guard, [&]() { return queue_limit > _queue.size(); });
+	}
+	_in_flight[src.dest]++;
+	_queue.push_back(std::move(src));
+	_stats.queued++;
+	guard.unlock();
+	_changed.notify_all();
+}
+
+void savefile::wait(const std::string& dest)
+{
+	std::unique_lock<std::mutex> guard(_lock);
+	_changed.wait(guard, [&]() { return !_in_flight.count(dest); });
+	report(guard);
+}
+
+void savefile::drain()
+{
+	std::unique_lock<std::mutex> guard(_lock);
+	_changed.wait(guard, [&]() { return _queue.empty(); });
+	report(guard);
+}
+
+bool savefile::read(const std::string& src, std::string& dest, bool binary)
+{
+	wait(src);
+	std::ostringstream contents;
+	{
+	std::ifstream fin(src.c_str(), std::ios::binary);
+	if (!fin) return false;
+	contents << fin.rdbuf();
+	}
+	dest = contents.str();
+	if (cataclysm::savepack::is_packed(dest)) {
+		try {
+			dest = cataclysm::savepack::unpack(dest);
+		} catch (const std::exception& e) {
+			debuglog("%s: %s", src.c_str(), e.what());
+			throw std::runtime_error(src + ": " + e.what());
+		}
+		return true;
+	}
+	if (binary) return true;
+	// plain text: re-read in text mode, as these files always were
+	contents.str("");
+	std::ifstream fin(src.c_str());
+	if (!fin) return false;
+	contents << fin.rdbuf();
+	dest = contents.str();
+	return true;
+}
+
+savefile::stats savefile::statistics()
+{
+	std::unique_lock<std::mutex> guard(_lock);
+	return _stats;
+}
+
+// main thread only: the UI is not thread-safe
+void savefile::report(std::unique_lock<std::mutex>& guard)
+{
+	if (_failed.empty()) return;
+	std::vector<std::string> failed(std::move(_failed));
+	_failed.clear();
+	guard.unlock();
+	for (const auto& msg : failed) debugmsg("%s", msg.c_str());
+	guard.lock();
+}
+
+void savefile::run()
+{
+	std::unique_lock<std::mutex> guard(_lock);
+	do {
+		_changed.wait(guard, [&]() { return _stop || !_queue.empty(); });
+		if (_queue.empty()) return;	// stopping, and nothing left to write
+		const job& working = _queue.front();
+		guard.unlock();
+
+		const auto start = std::chrono::steady_clock::now();
+		const bool ok = write_now(working);
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		guard.lock();
+		_stats.write_ms += elapsed.count();
+		if (!ok) _failed.push_back("Failed to write to " + working.dest + ".");
+		auto it = _in_flight.find(working.dest);
+		if (0 == --it->second) _in_flight.erase(it);
+		_queue.pop_front();	// destroys the JSON snapshot on this thread
+		_changed.notify_all();
+	} while (true);
+}
+
+// whether dest holds exactly data, read back the way it was written
+static bool on_disk(const std::string& dest, const std::string& data, bool binary)
+{
+	FILE* const fin = fopen(dest.c_str(), binary ? "rb" : "r");
+	if (!fin) return false;
+	char buf[4096];
+	size_t at = 0;
+	bool same = true;
+	while (same) {
+		const size_t n = fread(buf, 1, sizeof(buf), fin);
+		if (0 == n) break;
+		same = n <= data.size() - at && 0 == memcmp(buf, data.data() + at, n);
+		at += n;
+	}
+	same = same && !ferror(fin) && data.size() == at;
+	fclose(fin);
+	return same;
+}
+
+// background thread
+bool savefile::write_now(const job& src)
+{
+	if (src.erase) {
+		_last.erase(src.dest);
+		unlink(src.tmp.c_str());
+		unlink(src.dest.c_str());
+		return true;
+	}
+
+	std::string formatted;
+	const std::string* data = &src.head;
+	if (cataclysm::JSON::none != src.body.mode()) {
+		std::ostringstream os;
+		os << src.head << src.body;
+		formatted = os.str();
+		data = &formatted;
+	}
+
+	// a change of container is a change
+	const std::pair<size_t, size_t> fingerprint(data->size(), std::hash<std::string_view>()(*data) + src.packed);
+	const bool binary = src.binary || src.packed;	// text files in text mode, as they always were
+	std::string packed;
+	const auto pack = [&]() {
+		if (!src.packed || &packed == data) return;
+		packed = cataclysm::savepack::pack(*data);
+		data = &packed;
+	};
+	auto it = _last.find(src.dest);
+	if (_last.end() != it && fingerprint == it->second) {
+		pack();
+		if (on_disk(src.dest, *data, binary)) {	// the fingerprint is only a hint: a collision must not drop a save
+			std::unique_lock<std::mutex> guard(_lock);
+			_stats.unchanged++;
+			return true;
+		}
+	}
+	pack();
+
+	FILE* const fout = fopen(src.tmp.c_str(), binary ? "wb" : "w");
+	if (!fout) return false;
+	bool ok = data->size() == fwrite(data->data(), 1, data->size(), fout);
+	ok = (0 == fflush(fout)) && ok;
+#ifdef ZAIMONI_HAS_MICROSOFT_IO_H
+	ok = ok && 0 == _commit(_fileno(fout));
+#else
+	ok = ok && 0 == fsync(fileno(fout));
+#endif
+	ok = (0 == fclose(fout)) && ok;
+	if (!ok) {
+		unlink(src.tmp.c_str());
+		_last.erase(src.dest);
+		return false;
+	}
+	// same sequence as OFSTREAM_ACID_CLOSE, keeping the previous file as the backup if asked
+	if (src.backup.empty()) unlink(src.dest.c_str());
+	else {
+		unlink(src.backup.c_str());
+		rename(src.dest.c_str(), src.backup.c_str());
+	}
+	rename(src.tmp.c_str(), src.dest.c_str());
+
+	_last[src.dest] = fingerprint;
+	std::unique_lock<std::mutex> guard(_lock);
+	_stats.written++;
+	_stats.bytes += data->size();
+	return true;
+}
@@ -0,0 +1,87 @@
+#ifndef SAVEFILE_HPP
+#define SAVEFILE_HPP 1
+
+#include "json.h"
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// singleton
+// Whole-file saves, written by a background thread: to a temporary, flushed to disk, then renamed over the destination
+// (optionally keeping the old one as a backup).  A file whose content is what was last written to it is not rewritten.
+// Callers hand over a snapshot -- bytes, and/or a JSON tree for the writer to format -- and continue.
+// With OPT_COMPRESS_SAVES, files go out in the savepack container; read() takes either kind, and checks the container.
+// Anything that reads a save file must read() it, or wait() for it (or drain()) first.
+class savefile
+{
+public:
+	static constexpr const size_t queue_limit = 64;	// writers block beyond this many files in flight
+
+	struct stats {
+		size_t queued;
+		size_t written;
+		size_t unchanged;	// skipped
+		size_t bytes;	// written
+		size_t stalls;	// writes that waited for room in the queue
+		double write_ms;	// background thread: formatting and writing
+	};
+
+private:
+	struct job {
+		std::string dest;
+		std::string tmp;
+		std::string backup;
+		std::string head;
+		cataclysm::JSON body;	// formatted after head, unless none
+		bool binary;
+		bool packed;	// as of when queued
+		bool erase = false;	// delete dest, rather than write it
+	};
+
+	std::mutex _lock;
+	std::condition_variable _changed;
+	std::deque<job> _queue;	// front is being written
+	std::map<std::string, size_t> _in_flight;	// destination: jobs queued or being written
+	std::vector<std::string> _failed;	// messages for the main thread
+	bool _stop;
+	stats _stats;
+	std::map<std::string, std::pair<size_t, size_t> > _last;	// background thread only: length, hash of the content last written; confirmed against the file before skipping
+	std::thread _writer;
+
+	savefile();
+	~savefile();
+	savefile(const savefile& src) = delete;
+	savefile(savefile&& src) = delete;
+	savefile& operator=(const savefile& src) = delete;
+	savefile& operator=(savefile&& src) = delete;
+
+	void enqueue(job&& src);
+	void run();
+	bool write_now(const job& src);
+	void report(std::unique_lock<std::mutex>& guard);
+public:
+	static savefile& get();
+
+	void write(const std::string& dest, const std::string& tmp, std::string&& head, cataclysm::JSON&& body, const std::string& backup = std::string());
+	void write(const std::string& dest, const std::string& tmp, std::string&& data, const std::string& backup = std::string()) {
+		write(dest, tmp, std::move(data), cataclysm::JSON(), backup);
+	}
+	void write(const std::string& dest, std::string&& data) { write(dest, dest + ".tmp", std::move(data)); }
+	void write_binary(const std::string& dest, std::string&& head, cataclysm::JSON&& body = cataclysm::JSON());
+	void write_plain(const std::string& dest, std::string&& data);	// never packed: Socrates' Daimon reads it too
+	void remove(const std::string& dest);	// after anything already queued for it
+
+	// false if src does not exist; throws std::runtime_error if its container is damaged
+	bool read(const std::string& src, std::string& dest, bool binary = false);
+	void wait(const std::string& dest);	// until dest is on disk
+	void drain();	// until everything is on disk
+
+	stats statistics();
+};
+
+#endif
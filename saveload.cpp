@@ -25,7 +25,9 @@
 #include "submap.h"
 #endif
 #include "json.h"
+#include "binary_io.hpp"
 
+#include <algorithm>
 #include <istream>
 #include <ostream>
 #include <sstream>
@@ -33,7 +35,7 @@
 #include "Zaimoni.STL/Logging.h"
 
 // enums.h doesn't have a recognizable implementation file, so park this here for now
-static const char* const JSON_transcode_material[] = {
+static constexpr const char* JSON_transcode_material[] = {
 	"LIQUID",
 	"VEGGY",
 	"FLESH",
@@ -53,7 +55,7 @@ static const char* const JSON_transcode_material[] = {
 };
 
 // while nc_color does have an implementation file, the header doesn't include enums.h or <string>
-static const char* const JSON_transcode_nc_color[] = {
+static constexpr const char* JSON_transcode_nc_color[] = {
 	"c_black",
 	"c_white",
 	"c_ltgray",
@@ -120,7 +122,7 @@ static const char* const JSON_transcode_nc_color[] = {
 };
 
 // relocate artifact enum JSON transcoding here for Socrates' Daimon
-static const char* const JSON_transcode_artifactactives[] = {
+static constexpr const char* JSON_transcode_artifactactives[] = {
 	"STORM",
 	"FIREBALL",
 	"ADRENALINE",
@@ -153,7 +155,7 @@ static const char* const JSON_transcode_artifactactives[] = {
 	"SHADOWS"
 };
 
-static const char* const JSON_transcode_artifactpassives[] = {
+static constexpr const char* JSON_transcode_artifactpassives[] = {
 	"STR_UP",
 	"DEX_UP",
 	"PER_UP",
@@ -192,7 +194,7 @@ static const char* const JSON_transcode_artifactpassives[] = {
 	"SICK"
 };
 
-static const char* const JSON_transcode_artifactcharging[] = {
+static constexpr const char* JSON_transcode_artifactcharging[] = {
 	"ARTC_TIME",
 	"ARTC_SOLAR",
 	"ARTC_PAIN",
@@ -386,7 +388,7 @@ bool fromJSON(const JSON& src, const itype*& dest)
 	if (!src.is_scalar()) return false;
 	itype_id type_id;
 	int artifact_id;
-	bool ret = fromJSON(src, type_id);
+	bool ret = fromJSON(src, type_id) && type_id;	// unrecognized names parse as 0; those may be artifacts
 	if (ret) dest = item::types[type_id];	// XXX \todo should be itype::types?
 	else if ((ret = fromJSON(src, artifact_id)) && item::types.size() > artifact_id+(num_all_items-1)) dest = item::types[artifact_id + (num_all_items - 1)];
 	else if ((ret = fromJSON(src, artifact_id)) && item::types.size() > artifact_id) dest = item::types[artifact_id];	// \todo V0.3.1+: remove, this is backward-compatibility
@@ -963,70 +965,90 @@ JSON toJSON(const item& src) {
 }
 
 #ifndef SOCRATES_DAIMON
+static int decay_radiation(int rad)
+{
+	int turndif = int(messages.turn);
+	if (turndif < 0) turndif = 0;
+	rad -= int(turndif / 100);	// Radiation slowly decays	\todo V 0.2.1+ handle this as a true game time effect; no saveload-purging of radiation
+	return (rad < 0) ? 0 : rad;
+}
+
+// terrain-like grids are stored row-major (j outer), as in operator<<(std::ostream&, const submap&)
+template<class T, class F>
+static bool read_grid(cataclysm::JSON_reader& src, T (&dest)[SEEX][SEEY], F decode)
+{
+	if (!src.begin_array()) {
+		src.skip();
+		return false;
+	}
+	int j = 0;
+	while (src.next_element()) {
+		if (j >= SEEY || !src.begin_array()) {
+			src.skip();
+			j++;
+			continue;
+		}
+		int i = 0;
+		while (src.next_element()) {
+			if (i < SEEX && src.scalar()) dest[i][j] = decode();
+			else src.skip();
+			i++;
+		}
+		j++;
+	}
+	return SEEY <= j;
+}
+
 submap::submap(std::istream& is, tripoint& gps) : submap(0)
 {
 	is >> turn_last_touched;
 	GPS = gps;
-	int turndif = int(messages.turn);
-	if (turndif < 0) turndif = 0;
 
 	if ('{' != (is >> std::ws).peek()) throw std::runtime_error("submap data lost: pre-V0.2.0 format?");
 	{
-		JSON sm(is);
-		ter_id terrain;
-		int radtmp;
-		if (sm.has_key("terrain") && JSON::array==sm["terrain"].mode() && SEEY <= sm["terrain"].size()) {
-			const auto& ter_map = sm["terrain"];
-			int j = -1;
-			while (++j < ter_map.size() && j < SEEY) {
-				auto& col = ter_map[j];
-				int i = -1;
-				while (++i < col.size() && i < SEEX) {
-					if (fromJSON(col[i], terrain)) ter[i][j] = terrain;
-				}
-			}
-		} else if (sm.has_key("const_terrain") && fromJSON(sm["const_terrain"], terrain)) {
-			for (int j = 0; j < SEEY; j++) {
-				for (int i = 0; i < SEEX; i++) {
-					ter[i][j] = terrain;
-				}
-			}
-		} else throw std::runtime_error("terrain data missing");
-
-		if (sm.has_key("radiation") && JSON::array == sm["radiation"].mode() && SEEY <= sm["radiation"].size()) {
-			const auto& rad_map = sm["radiation"];
-			int j = -1;
-			while (++j < rad_map.size() && j < SEEY) {
-				auto& col = rad_map[j];
-				int i = -1;
-				while (++i < col.size() && i < SEEX) {
-					if (fromJSON(col[i], radtmp)) {
-						radtmp -= int(turndif / 100);	// Radiation slowly decays	\todo V 0.2.1+ handle this as a true game time effect; no saveload-purging of radiation
-						if (radtmp < 0) radtmp = 0;
-						rad[i][j] = radtmp;
+		cataclysm::JSON_reader sm(is);
+		if (!sm.begin_object()) throw std::runtime_error("submap data lost");
+		bool have_terrain = false;
+		bool have_radiation = false;
+		while (sm.next_key()) {
+			const std::string key = sm.key();
+			if ("terrain" == key) {
+				cataclysm::JSON_parse<ter_id> parse;
+				have_terrain = read_grid(sm, ter, [&]() { return parse(sm.scalar_value()); }) || have_terrain;
+			} else if ("const_terrain" == key) {
+				ter_id terrain;
+				if (fromJSON(sm, terrain) && !have_terrain) {
+					for (int j = 0; j < SEEY; j++) {
+						for (int i = 0; i < SEEX; i++) {
+							ter[i][j] = terrain;
+						}
 					}
+					have_terrain = true;
 				}
-			}
-		}
-		else if (sm.has_key("const_radiation") && fromJSON(sm["const_radiation"], radtmp)) {
-			radtmp -= int(turndif / 100);	// Radiation slowly decays	\todo V 0.2.1+ handle this as a true game time effect; no saveload-purging of radiation
-			if (radtmp < 0) radtmp = 0;
-			for (int j = 0; j < SEEY; j++) {
-				for (int i = 0; i < SEEX; i++) {
-					rad[i][j] = radtmp;
+			} else if ("radiation" == key) {
+				have_radiation = read_grid(sm, rad, [&]() { return decay_radiation(int(stoll(sm.scalar_value()))); }) || have_radiation;
+			} else if ("const_radiation" == key) {
+				int radtmp;
+				if (fromJSON(sm, radtmp) && !have_radiation) {
+					radtmp = decay_radiation(radtmp);
+					for (int j = 0; j < SEEY; j++) {
+						for (int i = 0; i < SEEX; i++) {
+							rad[i][j] = radtmp;
+						}
+					}
+					have_radiation = true;
 				}
-			}
-		} else throw std::runtime_error("radiation data missing");
-
-		if (sm.has_key("spawns")) sm["spawns"].decode(spawns);
-		if (sm.has_key("vehicles")) {
-			sm["vehicles"].decode(vehicles);
-			for (decltype(auto) veh : vehicles) veh->GPSpos.first = gps; // V.0.2.4+ auto-repair
+			} else if ("spawns" == key) sm.decode(spawns);
+			else if ("vehicles" == key) {
+				sm.decode(vehicles);
+				for (decltype(auto) veh : vehicles) veh->GPSpos.first = gps; // V.0.2.4+ auto-repair
+			} else if ("comp" == key || "computer" == key) fromJSON(sm, comp);	// never written as "computer", but was read under it
+			else sm.skip();
 		}
-		if (sm.has_key("computer")) fromJSON(sm["computer"], comp);
+		if (!have_terrain) throw std::runtime_error("terrain data missing");
+		if (!have_radiation) throw std::runtime_error("radiation data missing");
 	}
 	// Load items and traps and fields and spawn points and vehicles
-	item it_tmp;
 	std::string string_identifier;
 	int itx, ity;
 	do {
@@ -1034,10 +1056,9 @@ submap::submap(std::istream& is, tripoint& gps) : submap(0)
 		int t = 0;
 		if (string_identifier == "I") {
 			is >> itx >> ity >> std::ws;
+			item it_tmp;	// fresh each time: fromJSON leaves keys it doesn't see alone
 			if (fromJSON(JSON(is), it_tmp)) {
 				itm[itx][ity].push_back(it_tmp);
-				if (it_tmp.active) active_item_count++;
-				if (!it_tmp.contents.empty()) for (const auto& it : it_tmp.contents) if (it.active) active_item_count++;
 			}
 		} else if (string_identifier == "T") {
 			is >> itx >> ity;
@@ -1051,7 +1072,6 @@ submap::submap(std::istream& is, tripoint& gps) : submap(0)
 		} else if (string_identifier == "F") {
 			is >> itx >> ity;
 			fromJSON(JSON(is), fld[itx][ity]);
-			field_count++;
 		} else if ("----" == string_identifier) {
 			is >> std::ws;	// to ensure we don't warn on trailing whitespace at end of file
 			break;
@@ -1142,6 +1162,270 @@ std::ostream& operator<<(std::ostream& os, const submap& src)
 	return os << "----" << std::endl;
 }
 
+// binary format.  Grids are run-length encoded in storage order; traps, fields and items are sparse, so those
+// record only occupied squares as (squares skipped, payload).  Items are a length-prefixed section of their own;
+// the rarely present spawns, vehicles and computer are a length-prefixed JSON object, as in the text format.
+template<class T> static void write_names(std::ostream& os, int n)
+{
+	cataclysm::binary::write_uint(os, n);
+	for (int i = 1; i < n; i++) {
+		const char* const name = JSON_key(T(i));
+		cataclysm::binary::write_string(os, name ? name : "");
+	}
+}
+
+template<class T> static std::vector<int> read_names(std::istream& is, int n)
+{
+	const auto stored = cataclysm::binary::read_uint(is);
+	if (stored > 4 * (unsigned long long)n + 1024) throw std::runtime_error("submap data: implausible id table");
+	std::vector<int> ret(stored, 0);
+	cataclysm::JSON_parse<T> parse;
+	for (size_t i = 1; i < stored; i++) {
+		const auto name = cataclysm::binary::read_string(is);
+		if (name.empty()) continue;
+		const char* const same = (i < n) ? JSON_key(T(i)) : nullptr;
+		ret[i] = (same && name == same) ? int(i) : int(parse(name));
+	}
+	return ret;
+}
+
+static int remap(const std::vector<int>& table, unsigned long long src) { return (src < table.size()) ? table[src] : 0; }
+
+void submap::id_tables::write(std::ostream& os)
+{
+	cataclysm::binary::write_uint(os, binary_version);
+	write_names<ter_id>(os, num_terrain_types);
+	write_names<trap_id>(os, num_trap_types);
+	write_names<field_id>(os, num_fields);
+	write_names<itype_id>(os, num_all_items);
+	write_names<mon_id>(os, num_monsters);
+}
+
+submap::id_tables submap::id_tables::read(std::istream& is)
+{
+	id_tables ret;
+	ret.version = cataclysm::binary::read_uint(is);
+	if (binary_version < ret.version) throw std::runtime_error("submap data: written by a newer version");
+	ret.ter = read_names<ter_id>(is, num_terrain_types);
+	ret.trap = read_names<trap_id>(is, num_trap_types);
+	ret.fld = read_names<field_id>(is, num_fields);
+	ret.itype = read_names<itype_id>(is, num_all_items);
+	ret.mon = read_names<mon_id>(is, num_monsters);
+	return ret;
+}
+
+// artifacts are numbered after the standard items, in the order of the artifact save file
+static const itype* read_itype(std::istream& is, const submap::id_tables& ids)
+{
+	const auto src = cataclysm::binary::read_uint(is);
+	if (src < ids.itype.size()) return ids.itype[src] ? item::types[ids.itype[src]] : nullptr;
+	const auto artifact = src - ids.itype.size() + num_all_items;
+	return (item::types.size() > artifact) ? item::types[artifact] : nullptr;
+}
+
+static void write_binary(std::ostream& os, const item& src)
+{
+	using namespace cataclysm::binary;
+	write_uint(os, src.type ? src.type->id : 0);
+	write_uint(os, src.corpse ? src.corpse->id : 0);
+	write_uint(os, src.curammo ? src.curammo->id : 0);
+	write_string(os, src.name);
+	write_int(os, src.invlet);
+	write_int(os, src.charges);
+	write_uint(os, src.active);
+	write_int(os, src.damage);
+	write_int(os, src.burnt);
+	write_uint(os, src.bday);
+	write_int(os, src.owned);
+	write_int(os, src.poison);
+	write_int(os, src.mission_id);
+	write_int(os, src.player_id);
+	write_uint(os, src.contents.size());
+	for (const auto& it : src.contents) write_binary(os, it);
+}
+
+static bool read_binary(std::istream& is, item& dest, const submap::id_tables& ids)
+{
+	using namespace cataclysm::binary;
+	dest.type = read_itype(is, ids);
+	const int corpse = remap(ids.mon, read_uint(is));
+	dest.corpse = corpse ? mtype::types[corpse] : nullptr;
+	dest.curammo = dynamic_cast<const it_ammo*>(read_itype(is, ids));
+	dest.name = read_string(is);
+	dest.invlet = char(read_int(is));
+	dest.charges = int(read_int(is));
+	dest.active = read_uint(is);
+	dest.damage = (signed char)read_int(is);
+	dest.burnt = char(read_int(is));
+	dest.bday = (unsigned int)read_uint(is);
+	dest.owned = int(read_int(is));
+	dest.poison = int(read_int(is));
+	dest.mission_id = int(read_int(is));
+	dest.player_id = int(read_int(is));
+	auto n = read_uint(is);
+	dest.contents.clear();
+	while (0 < n--) {
+		item tmp;
+		if (read_binary(is, tmp, ids)) dest.contents.push_back(std::move(tmp));
+	}
+	return dest.type;
+}
+
+template<class T, class Encode> static void write_runs(std::ostream& os, const T* src, Encode enc)
+{
+	const T* const end = src + SEEX * SEEY;
+	while (src < end) {
+		const T* run = src;
+		while (++run < end && *run == *src);
+		cataclysm::binary::write_uint(os, run - src);
+		enc(*src);
+		src = run;
+	}
+}
+
+template<class T, class Decode> static void read_runs(std::istream& is, T* dest, Decode dec)
+{
+	T* const end = dest + SEEX * SEEY;
+	while (dest < end) {
+		const auto len = cataclysm::binary::read_uint(is);
+		if (0 == len || (unsigned long long)(end - dest) < len) throw std::runtime_error("submap data: bad run length");
+		std::fill_n(dest, len, dec());
+		dest += len;
+	}
+}
+
+template<class T, class Test, class Encode> static void write_sparse(std::ostream& os, const T* src, Test present, Encode enc)
+{
+	cataclysm::binary::write_uint(os, std::count_if(src, src + SEEX * SEEY, present));
+	ptrdiff_t next = 0;
+	for (ptrdiff_t i = 0; i < SEEX * SEEY; i++) {
+		if (!present(src[i])) continue;
+		cataclysm::binary::write_uint(os, i - next);
+		enc(src[i]);
+		next = i + 1;
+	}
+}
+
+template<class T, class Decode> static void read_sparse(std::istream& is, T* dest, Decode dec)
+{
+	auto n = cataclysm::binary::read_uint(is);
+	unsigned long long i = 0;
+	while (0 < n--) {
+		i += cataclysm::binary::read_uint(is);
+		if (SEEX * SEEY <= i) throw std::runtime_error("submap data: square out of bounds");
+		dest[i++] = dec();
+	}
+}
+
+submap::submap(std::istream& is, const tripoint& gps, const id_tables& ids, bool decay) : submap(0)
+{
+	using namespace cataclysm::binary;
+	GPS = gps;
+	turn_last_touched = int(read_int(is));
+	read_runs(is, &ter[0][0], [&]() { return ter_id(remap(ids.ter, read_uint(is))); });
+	read_runs(is, &rad[0][0], [&]() { const int ret = int(read_int(is)); return decay ? decay_radiation(ret) : ret; });
+	read_sparse(is, &trp[0][0], [&]() { return trap_id(remap(ids.trap, read_uint(is))); });
+	read_sparse(is, &fld[0][0], [&]() {
+		field ret(field_id(remap(ids.fld, read_uint(is))));
+		ret.density = (signed char)read_int(is);
+		ret.age = int(read_int(is));
+		return ret;
+	});
+
+	{
+	std::istringstream items(read_string(is));
+	read_sparse(items, &itm[0][0], [&]() {
+		std::vector<item> ret;
+		auto n = read_uint(items);
+		ret.reserve(n);
+		while (0 < n--) {
+			item tmp;
+			if (!read_binary(items, tmp, ids)) continue;
+			ret.push_back(std::move(tmp));
+		}
+		return ret;
+	});
+	}
+
+	const auto misc = read_string(is);
+	if (misc.empty()) return;
+	std::istringstream misc_in(misc);
+	JSON sm(misc_in);
+	if (sm.has_key("spawns")) sm["spawns"].decode(spawns);
+	if (sm.has_key("vehicles")) {
+		sm["vehicles"].decode(vehicles);
+		for (decltype(auto) veh : vehicles) veh->GPSpos.first = gps;
+	}
+	if (sm.has_key("comp")) fromJSON(sm["comp"], comp);
+}
+
+void submap::write(std::ostream& os) const
+{
+	using namespace cataclysm::binary;
+	write_int(os, turn_last_touched);
+	write_runs(os, &ter[0][0], [&](ter_id x) { write_uint(os, x); });
+	write_runs(os, &rad[0][0], [&](int x) { write_int(os, x); });
+	write_sparse(os, &trp[0][0], [](trap_id x) { return tr_null != x; }, [&](trap_id x) { write_uint(os, x); });
+	write_sparse(os, &fld[0][0], [](const field& x) { return fd_null != x.type; }, [&](const field& x) {
+		write_uint(os, x.type);
+		write_int(os, x.density);
+		write_int(os, x.age);
+	});
+
+	{
+	std::ostringstream items;
+	write_sparse(items, &itm[0][0], [](const std::vector<item>& x) { return !x.empty(); }, [&](const std::vector<item>& x) {
+		write_uint(items, x.size());
+		for (const auto& it : x) write_binary(items, it);
+	});
+	write_string(os, items.str());
+	}
+
+	if (spawns.empty() && vehicles.empty() && comp.name.empty()) {
+		write_uint(os, 0);
+		return;
+	}
+	JSON sm(JSON::object);
+	if (!spawns.empty()) sm.set("spawns", JSON::encode(spawns));
+	if (!vehicles.empty()) sm.set("vehicles", JSON::encode(vehicles));
+	if (!comp.name.empty()) sm.set("comp", toJSON(comp));
+	std::ostringstream misc;
+	misc << sm;
+	write_string(os, misc.str());
+}
+
+bool submap::check_round_trip(size_t& text_bytes, size_t& binary_bytes) const
+{
+	std::ostringstream text;
+	text << *this;
+	std::ostringstream bin;
+	id_tables::write(bin);
+	const size_t header = bin.str().size();
+	write(bin);
+	text_bytes = text.str().size();
+	binary_bytes = bin.str().size() - header;
+
+	// loading decays radiation; everything else should come back as it was
+	submap expected(*this);
+	for (auto& col : expected.rad) for (auto& x : col) x = decay_radiation(x);
+	std::ostringstream want;
+	expected.write(want);
+
+	std::istringstream bin_in(bin.str());
+	const auto ids = id_tables::read(bin_in);
+	const submap from_binary(bin_in, GPS, ids, true);
+	std::ostringstream got;
+	from_binary.write(got);
+	if (got.str() != want.str()) return false;
+
+	std::istringstream text_in(text.str());
+	tripoint gps = GPS;
+	const submap from_text(text_in, gps);
+	got.str("");
+	from_text.write(got);
+	return got.str() == want.str();
+}
+
 bool fromJSON(const JSON& _in, faction& dest)
 {
 	if (!_in.has_key("id") || !fromJSON(_in["id"], dest.id)) return false;	// \todo do we want to interpolate this key?
@@ -0,0 +1,192 @@
+#include "savepack.hpp"
+#include "binary_io.hpp"
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+
+namespace cataclysm {
+namespace savepack {
+
+static const char magic[4] = { 'C', 'S', 'Z', '\x01' };
+
+static constexpr const int min_match = 4;
+static constexpr const int hash_bits = 13;
+
+struct crc_table {
+	uint32_t x[256];
+
+	constexpr crc_table() : x{} {
+		for (uint32_t n = 0; n < 256; n++) {
+			uint32_t c = n;
+			for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+			x[n] = c;
+		}
+	}
+};
+
+static constexpr const crc_table crc_bytes;
+
+uint32_t crc32(std::string_view src, uint32_t crc)
+{
+	crc = ~crc;
+	for (const unsigned char c : src) crc = crc_bytes.x[(crc ^ c) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+bool is_packed(std::string_view src)
+{
+	return sizeof(magic) <= src.size() && 0 == memcmp(src.data(), magic, sizeof(magic));
+}
+
+static uint32_t read32(const char* src)
+{
+	uint32_t ret;
+	memcpy(&ret, src, sizeof(ret));
+	return ret;
+}
+
+static unsigned hash(uint32_t src) { return (src * 2654435761U) >> (32 - hash_bits); }
+
+// lengths of 15 or more continue in following bytes, 255 at a time
+static void put_length(std::string& dest, size_t len)
+{
+	while (255 <= len) {
+		dest.push_back(char(255));
+		len -= 255;
+	}
+	dest.push_back(char(len));
+}
+
+static void put_sequence(std::string& dest, const char* literals, size_t lit_len, size_t offset, size_t match_len)
+{
+	const size_t lit_code = 15 <= lit_len ? 15 : lit_len;
+	const size_t match_code = !offset ? 0 : (15 <= match_len - min_match ? 15 : match_len - min_match);
+	dest.push_back(char((lit_code << 4) | match_code));
+	if (15 <= lit_len) put_length(dest, lit_len - 15);
+	dest.append(literals, lit_len);
+	if (!offset) return;	// final literals
+	dest.push_back(char(offset & 0xFF));
+	dest.push_back(char(offset >> 8));
+	if (15 <= match_len - min_match) put_length(dest, match_len - min_match - 15);
+}
+
+static std::string compress(std::string_view src)
+{
+	std::string ret;
+	ret.reserve(src.size() / 2);
+	int table[1 << hash_bits];
+	memset(table, -1, sizeof(table));
+	const char* const base = src.data();
+	const size_t n = src.size();
+	size_t anchor = 0;
+	size_t i = 0;
+	while (i + min_match <= n) {
+		const uint32_t head = read32(base + i);
+		int& slot = table[hash(head)];
+		const int cand = slot;
+		slot = int(i);
+		if (0 > cand || head != read32(base + cand)) {
+			i++;
+			continue;
+		}
+		size_t len = min_match;
+		while (i + len < n && base[cand + len] == base[i + len]) len++;
+		put_sequence(ret, base + anchor, i - anchor, i - cand, len);
+		i += len;
+		anchor = i;
+	}
+	put_sequence(ret, base + anchor, n - anchor, 0, 0);
+	return ret;
+}
+
+// false for a malformed record
+static bool decompress(std::string_view src, char* dest, size_t n)
+{
+	const unsigned char* in = reinterpret_cast<const unsigned char*>(src.data());
+	const unsigned char* const in_end = in + src.size();
+	size_t out = 0;
+	auto get_length = [&](size_t& len) {
+		unsigned c;
+		do {
+			if (in_end == in) return false;
+			c = *in++;
+			len += c;
+		} while (255 == c);
+		return true;
+	};
+	while (in < in_end) {
+		const unsigned token = *in++;
+		size_t lit_len = token >> 4;
+		if (15 == lit_len && !get_length(lit_len)) return false;
+		if (size_t(in_end - in) < lit_len || n - out < lit_len) return false;
+		memcpy(dest + out, in, lit_len);
+		in += lit_len;
+		out += lit_len;
+		if (in_end == in) break;	// final literals
+		if (2 > in_end - in) return false;
+		const size_t offset = in[0] | (size_t(in[1]) << 8);
+		in += 2;
+		size_t match_len = token & 15;
+		if (15 == match_len && !get_length(match_len)) return false;
+		match_len += min_match;
+		if (!offset || out < offset || n - out < match_len) return false;
+		const char* from = dest + out - offset;
+		for (size_t k = 0; k < match_len; k++) dest[out + k] = from[k];	// may overlap
+		out += match_len;
+	}
+	return n == out;
+}
+
+std::string pack(std::string_view src)
+{
+	std::ostringstream ret;
+	ret.write(magic, sizeof(magic));
+	while (!src.empty()) {
+		const std::string_view raw = src.substr(0, record_size);
+		src.remove_prefix(raw.size());
+		const std::string packed = compress(raw);
+		const bool stored = packed.size() >= raw.size();
+		binary::write_uint(ret, raw.size());
+		binary::write_uint(ret, stored ? raw.size() : packed.size());
+		const uint32_t crc = crc32(raw);
+		for (int k = 0; k < 4; k++) ret.put(char(crc >> (8 * k)));
+		if (stored) ret.write(raw.data(), raw.size());
+		else ret.write(packed.data(), packed.size());
+	}
+	binary::write_uint(ret, 0);
+	return ret.str();
+}
+
+std::string unpack(std::string_view src)
+{
+	if (!is_packed(src)) throw std::runtime_error("not a packed save file");
+	std::istringstream in(std::string(src.substr(sizeof(magic))));
+	std::string ret;
+	std::string packed;
+	size_t record = 0;
+	do {
+		const auto raw_len = binary::read_uint(in);	// throws on truncation
+		if (!raw_len) break;
+		const auto packed_len = binary::read_uint(in);
+		if (record_size < raw_len || packed_len > raw_len) throw std::runtime_error("record " + std::to_string(record) + " has a damaged header");
+		uint32_t crc = 0;
+		for (int k = 0; k < 4; k++) {
+			const int c = in.get();
+			if (std::char_traits<char>::eof() == c) throw std::runtime_error("binary data truncated");
+			crc |= uint32_t((unsigned char)c) << (8 * k);
+		}
+		packed.resize(packed_len);
+		if (!in.read(packed.data(), packed_len)) throw std::runtime_error("binary data truncated");
+		const size_t origin = ret.size();
+		ret.resize(origin + raw_len);
+		if (packed_len == raw_len) memcpy(ret.data() + origin, packed.data(), raw_len);
+		else if (!decompress(packed, ret.data() + origin, raw_len)) throw std::runtime_error("record " + std::to_string(record) + " does not decompress");
+		if (crc != crc32(std::string_view(ret.data() + origin, raw_len))) throw std::runtime_error("record " + std::to_string(record) + " fails its checksum");
+		record++;
+	} while (true);
+	if (std::char_traits<char>::eof() != in.peek()) throw std::runtime_error("data after the last record");
+	return ret;
+}
+
+}	// namespace savepack
+}	// namespace cataclysm
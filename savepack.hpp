@@ -0,0 +1,26 @@
+#ifndef SAVEPACK_HPP
+#define SAVEPACK_HPP 1
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+
+// compressed container for save files: magic, then records of up to record_size bytes each, then an empty record.
+// Each record is its raw length, its packed length (equal to the raw length when stored as-is), the CRC-32 of the
+// raw bytes, and the packed bytes.  The codec is LZ77 in the manner of LZ4: literal runs and back-references within the record.
+namespace cataclysm {
+namespace savepack {
+
+static constexpr const size_t record_size = 1 << 16;	// back-references are 16-bit
+
+uint32_t crc32(std::string_view src, uint32_t crc = 0);
+
+bool is_packed(std::string_view src);
+std::string pack(std::string_view src);
+// throws std::runtime_error for a damaged container
+std::string unpack(std::string_view src);
+
+}	// namespace savepack
+}	// namespace cataclysm
+
+#endif
@@ -1,7 +1,7 @@
 #include "skill.h"
 #include <string.h>
 
-static const char* const JSON_transcode[] = {
+static constexpr const char* JSON_transcode[] = {
 	"dodge",
 	"melee",
 	"unarmed",
@@ -41,12 +41,10 @@ using namespace cataclysm;
 
 skill JSON_parse<skill>::operator()(const char* const src)
 {
-	if (!src || !src[0]) return sk_null;
-    std::ptrdiff_t i = sizeof(JSON_transcode) / sizeof(*JSON_transcode);
-	while (0 < i--) {
-		if (!strcmp(JSON_transcode[i], src)) return (skill)(i + 1);
-	}
-	return sk_null;
+	static constexpr const enum_hash::table<sizeof(JSON_transcode) / sizeof(*JSON_transcode)> index(JSON_transcode);
+	static_assert(index.round_trip(JSON_transcode), "skill JSON keys do not round-trip");
+	const auto i = index.find(JSON_transcode, src);
+	return 0 <= i ? (skill)(i + 1) : sk_null;
 }
 
 // cf player::disp_info: implied maximum length 17?
@@ -2,10 +2,21 @@
 #include "monster.h"
 #include "output.h"
 #include "Zaimoni.STL/Logging.h"
+#include <algorithm>
+
+unsigned long long submap::revision_counter = 0;
+
+ter_ref& ter_ref::operator=(ter_id src)
+{
+    if (_sm) _sm->touch();
+    _x = src;
+    return *this;
+}
 
 void submap::set(const tripoint src, int t0, const Badge<mapbuffer>& auth) {
     turn_last_touched = t0;
     GPS = src;
+    vehicles_moved();
 
     // Automatic-repair anything with GPSpos fields, here.  Catches mapgen mismatches between game::lev and the global position of the submap chunk.
     for (decltype(auto) veh : vehicles) veh->GPSpos.first = src;
@@ -13,10 +24,49 @@ void submap::set(const tripoint src, int t0, const Badge<mapbuffer>& auth) {
 
 void submap::add(item&& new_item, const point& dest)
 {
-    if (new_item.active) active_item_count++;
+    if (new_item.active) note_active(dest);
     items_at(dest).push_back(std::move(new_item));
 }
 
+void submap::note_active(const point& p)
+{
+    const auto it = std::lower_bound(active_items.begin(), active_items.end(), p, sweeps_before);
+    if (active_items.end() == it || p != *it) active_items.insert(it, p);
+}
+
+void submap::note_field(const point& p)
+{
+    const auto it = std::lower_bound(field_tiles.begin(), field_tiles.end(), p, sweeps_before);
+    if (field_tiles.end() == it || p != *it) field_tiles.insert(it, p);
+}
+
+void submap::_index_fields()
+{
+    field_tiles.clear();
+    point pt;
+    for (pt.x = 0; pt.x < SEEX; pt.x++) {
+        for (pt.y = 0; pt.y < SEEY; pt.y++) {
+            if (!fld[pt.x][pt.y].is_idle()) field_tiles.push_back(pt);
+        }
+    }
+}
+
+void submap::_index_active_items()
+{
+    active_items.clear();
+    point pt;
+    for (pt.x = 0; pt.x < SEEX; pt.x++) {
+        for (pt.y = 0; pt.y < SEEY; pt.y++) {
+            for (const auto& it : itm[pt.x][pt.y]) {
+                if (it.active) {
+                    active_items.push_back(pt);
+                    break;
+                }
+            }
+        }
+    }
+}
+
 std::optional<item> submap::for_drop(ter_id dest, const itype* type, int birthday)
 {
     if (type->is_style()) return std::nullopt;
@@ -34,13 +84,18 @@ field* submap::add(const point& p, field&& src)
     else if (!fd.is_null()) return nullptr; // Blood & bile are null too
     if (3 < src.density) src.density = 3;
     if (0 >= src.density) return nullptr;
-    if (fd.type == fd_null) field_count++;
+    note_field(p);
     return &(fd = std::move(src));
 }
 
 void submap::remove_field(const point& p) {
-    if (fld[p.x][p.y].type != fd_null) field_count--;
-    fld[p.x][p.y] = field();
+    fld[p.x][p.y] = field();    // field_tiles is pruned by process_fields
+}
+
+void submap::replace_field(const point& p, field&& src)
+{
+    note_field(p);
+    fld[p.x][p.y] = std::move(src);
 }
 
 void submap::add_spawn(mon_id type, int count, const point& pt, bool friendly, int faction_id, int mission_id, std::string name)
@@ -58,15 +113,32 @@ void submap::add_spawn(const monster& mon)
     add_spawn(mon_id(mon.type->id), 1, mon.GPSpos.second, (mon.friendly < 0), mon.faction_id, mon.mission_id, mon.unique_name);
 }
 
-std::optional<std::pair<vehicle*, int>> submap::veh_at(const GPS_loc& loc)
+static bool veh_tile_before(const GPS_loc& lhs, const GPS_loc& rhs)
 {
+    if (lhs.first.x != rhs.first.x) return lhs.first.x < rhs.first.x;
+    if (lhs.first.y != rhs.first.y) return lhs.first.y < rhs.first.y;
+    if (lhs.first.z != rhs.first.z) return lhs.first.z < rhs.first.z;
+    if (lhs.second.x != rhs.second.x) return lhs.second.x < rhs.second.x;
+    return lhs.second.y < rhs.second.y;
+}
+
+void submap::index_vehicles() const
+{
+    veh_index.clear();
     for (decltype(auto) veh : vehicles) {
-        const auto delta = loc - veh->GPSpos;
-        if (const point* const pt = std::get_if<point>(&delta)) { // gross invariant failure: vehicles should have GPSpos tripoint of their submap
-            int part = veh->part_at(*pt);
-            if (part >= 0) return std::pair(veh.get(), part);
-        }
+        for (const int p : veh->external_parts) veh_index.push_back({ veh->GPSpos + veh->parts[p].precalc_d[0], veh.get(), p });
     }
+    // vehicles should not overlap; if they do, the first one listed wins, as for a linear scan
+    std::stable_sort(veh_index.begin(), veh_index.end(), [](const veh_tile& lhs, const veh_tile& rhs) { return veh_tile_before(lhs.loc, rhs.loc); });
+    veh_index_revision = vehicle_revision.value;
+}
+
+std::optional<std::pair<vehicle*, int>> submap::veh_at(const GPS_loc& loc)
+{
+    if (vehicles.empty()) return std::nullopt;
+    if (vehicle_revision.value != veh_index_revision) index_vehicles();
+    const auto it = std::lower_bound(veh_index.begin(), veh_index.end(), loc, [](const veh_tile& lhs, const GPS_loc& rhs) { return veh_tile_before(lhs.loc, rhs); });
+    if (veh_index.end() != it && loc == it->loc) return std::pair(it->veh, it->part);
     return std::nullopt;
 }
 
@@ -95,6 +167,7 @@ vehicle* submap::add_vehicle(vhtype_id type, point pos, int deg)
     assert(in_bounds(pos));
     vehicles.emplace_back(new vehicle(type, deg));
     vehicles.back()->GPSpos = GPS_loc(GPS, pos);
+    vehicles_moved();
     return vehicles.back().get();
 }
 
@@ -103,16 +176,18 @@ void submap::add(std::shared_ptr<vehicle> veh, const Badge<map>& auth)
     if (veh) {
         veh->GPSpos.first = GPS; // enforce invariant
         vehicles.push_back(veh);
+        vehicles_moved();
     };
 }
 
-void submap::destroy(vehicle& veh)
+void submap::destroy(vehicle& veh, const Badge<map>& auth)
 {
     int i = -1;
     for (decltype(auto) v : vehicles) {
         ++i;
         if (v.get() == &veh) {
             EraseAt(vehicles, i);
+            vehicles_moved();
             return;
         }
     }
@@ -138,12 +213,15 @@ void submap::mapgen_swap(submap& dest, const Badge<map>& auth) {
     vehicles.swap(dest.vehicles);
     for (decltype(auto) veh : vehicles) veh->GPSpos.first = GPS;
     for (decltype(auto) veh : dest.vehicles) veh->GPSpos.first = dest.GPS;
+    vehicles_moved();
+    dest.vehicles_moved();
 }
 
 void submap::mapgen_move_cycle(submap* const* cycle, ptrdiff_t ub, const Badge<map>& auth)
 {
     assert(2 <= ub);
     assert(cycle);
+    const ptrdiff_t n = ub;
 
     computer   t_comp(std::move(cycle[--ub]->comp));
     vehicles_t t_vehs(std::move(cycle[ub]->vehicles));
@@ -158,12 +236,14 @@ void submap::mapgen_move_cycle(submap* const* cycle, ptrdiff_t ub, const Badge<m
     cycle[0]->comp     = std::move(t_comp);
     cycle[0]->spawns = std::move(t_spawns);
     cycle[0]->vehicles = std::move(t_vehs);
+    for (ub = 0; ub < n; ub++) cycle[ub]->vehicles_moved();
 }
 
 void submap::mapgen_xform(point(*op)(const point&), const Badge<map>& auth)
 {
     for (decltype(auto) veh : vehicles) veh->GPSpos.second = op(veh->GPSpos.second);
     for (decltype(auto) sp : spawns) sp.pos = op(sp.pos);
+    vehicles_moved();
 }
 
 void submap::post_init(const Badge<defense_game>& auth)
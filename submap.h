@@ -34,6 +34,21 @@ struct spawn_point {
 
 struct submap {
 private:
+    // Unique across all submaps, copies included: a copy (and the source of a move) draws a fresh value, so a cache
+    // keyed on a submap's address and revision cannot take the copy, or what is left after a move, for the original.
+    struct revision_t {
+        unsigned long long value;
+
+        revision_t() noexcept : value(++revision_counter) {}
+        revision_t(const revision_t& src) noexcept : revision_t() {}
+        revision_t(revision_t&& src) noexcept : revision_t() { src.bump(); }
+        ~revision_t() = default;
+        revision_t& operator=(const revision_t& src) noexcept { bump(); return *this; }
+        revision_t& operator=(revision_t&& src) noexcept { bump(); src.bump(); return *this; }
+
+        void bump() { value = ++revision_counter; }
+    };
+
     std::vector<item> itm[SEEX][SEEY]; // Items on each square
     std::vector<spawn_point> spawns;
     std::vector<std::shared_ptr<vehicle> > vehicles;
@@ -42,15 +57,43 @@ private:
     int     rad[SEEX][SEEY]; // Irradiation of each square
     ter_id  ter[SEEX][SEEY]; // Terrain on each square
     trap_id trp[SEEX][SEEY]; // Trap on each square
-    int active_item_count;
-    int field_count;
+    std::vector<point> active_items;    // tiles that may hold an active item, ordered as process_active_items sweeps
+    std::vector<point> field_tiles;     // tiles that may hold a field that is not idle, ordered as process_fields sweeps
     int turn_last_touched;
     tripoint GPS;   // cache field -- GPS_loc first coordinate, where we are
+    revision_t revision;   // cache field -- changes whenever terrain has been written
+    revision_t vehicle_revision;   // cache field -- changes whenever a vehicle that may reach into us has moved
+    std::string page_bytes;   // cache field -- binary encoding as last written to (or read from) its page
+    bool page_lent;   // cache field -- handed out since page_bytes was taken, so may no longer match it
+    struct veh_tile {
+        GPS_loc loc;
+        vehicle* veh;
+        int part;
+    };
+    mutable std::vector<veh_tile> veh_index;    // cache field -- external parts of our vehicles, ordered by location
+    mutable unsigned long long veh_index_revision = ~0ULL;    // cache field -- vehicle_revision when veh_index was built
+
+    static unsigned long long revision_counter;
+
+    void index_vehicles() const;
+    static bool sweeps_before(const point& lhs, const point& rhs) { return lhs.x < rhs.x || (lhs.x == rhs.x && lhs.y < rhs.y); }
+    void note_active(const point& p);
+    void _index_active_items();
+    void _process_active_items(); // map.cpp; only caller there
+    void note_field(const point& p);
+    void _index_fields();
+    bool _process_fields(); // field.cpp
 
 public:
     using vehicles_t = decltype(vehicles);
     using proxy_vehicles_t = std::vector<std::weak_ptr<vehicle> >;
 
+    // map-level tile caches compare against these to decide whether they are stale
+    unsigned long long tile_revision() const { return revision.value; }
+    unsigned long long vehicle_tile_revision() const { return vehicle_revision.value; }
+    void touch() { revision.bump(); }
+    void vehicles_moved() { vehicle_revision.bump(); }
+
     friend std::ostream& operator<<(std::ostream& os, const submap& src);
 
     submap() = delete;
@@ -64,7 +107,25 @@ public:
     submap(std::istream& is, tripoint& gps);
     friend std::ostream& operator<<(std::ostream& os, const submap& src);
 
+    // binary save format (saveload.cpp); the JSON-based text format above remains for import/export
+    static constexpr const unsigned int binary_version = 1;
+    struct id_tables {  // stored id -> this build's id, read from the names a page was written with
+        unsigned int version;
+        std::vector<int> ter, trap, fld, itype, mon;
+
+        static void write(std::ostream& os);    // this build's names
+        static id_tables read(std::istream& is);
+    };
+    submap(std::istream& is, const tripoint& gps, const id_tables& ids, bool decay);	// decay: radiation, once per session
+    void write(std::ostream& os) const;
+    // both formats decode to what was encoded; false if not.  Encoded sizes for comparison.
+    bool check_round_trip(size_t& text_bytes, size_t& binary_bytes) const;
+
     void set(const tripoint src, int t0, const Badge<mapbuffer>& auth);
+    int last_touched() const { return turn_last_touched; }
+    void set_last_touched(int t0, const Badge<mapbuffer>& auth) { turn_last_touched = t0; }
+    std::string& page_cache(const Badge<mapbuffer>& auth) { return page_bytes; }
+    bool& lent(const Badge<mapbuffer>& auth) { return page_lent; }
     GPS_loc toGPS(const point& origin, const Badge<map>& auth) const { return GPS_loc(GPS, origin); }
 
     static constexpr bool in_bounds(int x, int y) { return 0 <= x && x < SEE && 0 <= y && y < SEE; }
@@ -73,7 +134,7 @@ public:
 
     int& radiation(const point& p) { return rad[p.x][p.y]; }
     int radiation(const point& p) const { return rad[p.x][p.y]; }
-    ter_id& terrain(const point& p) { return ter[p.x][p.y]; }
+    ter_ref terrain(const point& p) { return ter_ref(this, ter[p.x][p.y]); }
     ter_id terrain(const point& p) const { return ter[p.x][p.y]; }
     trap_id& trap_at(const point& p) { return trp[p.x][p.y]; }
     trap_id trap_at(const point& p) const { return trp[p.x][p.y]; }
@@ -81,6 +142,7 @@ public:
     field& field_at(const point& p) { return fld[p.x][p.y]; }
     const field& field_at(const point& p) const { return fld[p.x][p.y]; }
     void remove_field(const point& p);
+    void replace_field(const point& p, field&& src);  // unconditional, unlike add
     field* add(const point& p, field&& src);
 
     std::vector<item>& items_at(const point& p) { return itm[p.x][p.y]; }
@@ -92,8 +154,13 @@ public:
     template<t_flag flag> bool has_flag_ter_only(const point& pt) const { return ter_t::list[ter[pt.x][pt.y]].flags & mfb(flag); };
     int move_cost_ter_only(const point& pt) const { return ter_t::list[ter[pt.x][pt.y]].movecost; };
 
-    void process_active_items(); // map.cpp; only caller there
-    bool process_fields(); // field.cpp
+    void process_active_items() { if (!active_items.empty()) _process_active_items(); }
+    bool process_fields() { return !field_tiles.empty() && _process_fields(); }
+    // on entering the reality bubble: loading and mapgen place items and fields without add()
+    void rebuild_indexes(const Badge<map>& auth) {
+        _index_active_items();
+        _index_fields();
+    }
 
     void add_spawn(mon_id type, int count, const point& pt, bool friendly, int faction_id, int mission_id, std::string name); // mapgen.cpp
     void add_spawn(const monster& mon); // mapgen.cpp
@@ -106,9 +173,10 @@ public:
 
     vehicle* add_vehicle(vhtype_id type, point pos, int deg);
     void add(std::shared_ptr<vehicle> veh, const Badge<map>& auth);
-    void destroy(vehicle& veh);
+    void destroy(vehicle& veh, const Badge<map>& auth);	// only invalidates our own tile slice; map::remove_vehicle covers those around us
     std::optional<std::pair<vehicle*, int>> veh_at(const GPS_loc& loc);
     std::optional<std::pair<const vehicle*, int>> veh_at(const GPS_loc& loc) const;
+    const vehicles_t& vehicles_here(const Badge<map>& auth) const { return vehicles; }
 
     void veh_gain_moves(proxy_vehicles_t& acc, const Badge<map>& auth);
 
@@ -0,0 +1,220 @@
+#include "submap_graph.hpp"
+#include "mapbuffer.h"
+#include "overmap.h"
+#include "line.h"
+#include "recent_msg.h"
+#include "Zaimoni.STL/GDI/box.hpp"
+
+#include <algorithm>
+
+submap_graph& submap_graph::get()
+{
+	static submap_graph ooao;
+	return ooao;
+}
+
+bool submap_graph::is_passable(ter_id t)
+{
+	return 0 < ter_t::list[t].movecost || is<bashable>(t) || t_door_c == t;
+}
+
+void submap_graph::build(connectivity& dest, const submap& sm)
+{
+	dest.revision = sm.tile_revision();
+	dest.synthetic = false;
+	dest.regions = 0;
+	memset(dest.label, 0, sizeof(dest.label));
+
+	point stack[SEE * SEE];
+	point pt;
+	for (pt.x = 0; pt.x < SEE; pt.x++) {
+		for (pt.y = 0; pt.y < SEE; pt.y++) {
+			if (dest.label[pt.x][pt.y] || !is_passable(sm.terrain(pt))) continue;
+			const unsigned char label = ++dest.regions;
+			size_t ub = 0;
+			dest.label[pt.x][pt.y] = label;
+			stack[ub++] = pt;
+			while (0 < ub) {
+				const point cur = stack[--ub];
+				for (decltype(auto) dir : Direction::vector) {
+					const point next = cur + dir;
+					if (!submap::in_bounds(next) || dest.label[next.x][next.y]) continue;
+					if (!is_passable(sm.terrain(next))) continue;
+					dest.label[next.x][next.y] = label;
+					stack[ub++] = next;
+				}
+			}
+		}
+	}
+}
+
+void submap_graph::build(connectivity& dest, const tripoint& sm)
+{	// not generated yet: assume open ground unless the overmap says river
+	dest.revision = 0;
+	dest.synthetic = true;
+	const oter_id terrain = overmap::ter_c(overmap::toOvermap(GPS_loc(sm, point(0))));
+	const bool blocked = ot_river_center <= terrain && ot_river_nw >= terrain;
+	dest.regions = blocked ? 0 : 1;
+	memset(dest.label, dest.regions, sizeof(dest.label));
+}
+
+const submap_graph::connectivity& submap_graph::lookup(const tripoint& sm)
+{	// revisions are unique across submaps, so an unchanged one means the same terrain
+	auto it = _cache.find(sm);
+	const bool fresh = _cache.end() == it;
+	if (fresh) {
+		if (cache_budget <= _cache.size()) evict();
+		it = _cache.emplace(sm, connectivity()).first;
+	}
+	auto& dest = it->second;
+	dest.last_used = int(messages.turn);
+	if (const submap* const src = MAPBUFFER.peek_submap(sm)) {
+		if (fresh || dest.synthetic || src->tile_revision() != dest.revision) build(dest, *src);
+	} else if (fresh) build(dest, sm);
+	return dest;
+}
+
+void submap_graph::evict()
+{	// keep the more recently used half; route() only holds on to entries it used this turn
+	std::vector<int> used;
+	used.reserve(_cache.size());
+	for (const auto& x : _cache) used.push_back(x.second.last_used);
+	const auto median = used.begin() + used.size() / 2;
+	std::nth_element(used.begin(), median, used.end());
+	const int cutoff = std::min(*median, int(messages.turn));
+	std::erase_if(_cache, [&](const auto& x) { return x.second.last_used < cutoff; });
+}
+
+unsigned char submap_graph::label(const GPS_loc& loc)
+{
+	return lookup(loc.first).label[loc.second.x][loc.second.y];
+}
+
+std::optional<std::vector<submap_graph::region> > submap_graph::route(const GPS_loc& src, const OM_loc<2>& dest, size_t budget)
+{
+	if (src.first.z != dest.first.z) return std::nullopt;	// no z-level transitions at this level of detail
+	const unsigned char start_label = label(src);
+	if (!start_label) return std::nullopt;
+
+	// destination overmap tile covers a 2x2 block of submaps
+	const point goal_min(dest.first.x * 2 * OMAP + 2 * dest.second.x, dest.first.y * 2 * OMAP + 2 * dest.second.y);
+	const zaimoni::gdi::box<point> goal(goal_min, goal_min + point(1));
+	const auto in_goal = [&](const tripoint& sm) { return goal.contains(point(sm.x, sm.y)); };
+	const auto heuristic = [&](const tripoint& sm) {
+		const point pt(sm.x, sm.y);
+		point delta(0);
+		if (pt.x < goal.tl_c().x) delta.x = goal.tl_c().x - pt.x;
+		else if (pt.x > goal.br_c().x) delta.x = pt.x - goal.br_c().x;
+		if (pt.y < goal.tl_c().y) delta.y = goal.tl_c().y - pt.y;
+		else if (pt.y > goal.br_c().y) delta.y = pt.y - goal.br_c().y;
+		return SEE * std::max(delta.x, delta.y);
+	};
+
+	struct node {
+		int gscore;
+		bool closed;
+		region parent;
+	};
+	struct open_entry {
+		int score;
+		unsigned int seq;
+		region r;
+
+		// std::push_heap et al. build a max-heap; invert so the best entry is on top
+		bool operator<(const open_entry& rhs) const {
+			if (score != rhs.score) return score > rhs.score;
+			return seq > rhs.seq;
+		}
+	};
+
+	std::map<region, node> nodes;
+	std::vector<open_entry> open;
+	unsigned int seq = 0;
+
+	const region start(src.first, start_label);
+	nodes[start] = node{ 0, false, start };
+	open.push_back(open_entry{ heuristic(src.first), seq++, start });
+
+	while (!open.empty() && 0 < budget) {
+		std::pop_heap(open.begin(), open.end());
+		const open_entry cur = open.back();
+		open.pop_back();
+		auto& cur_node = nodes[cur.r];
+		if (cur_node.closed || cur.score != cur_node.gscore + heuristic(cur.r.first)) continue;	// stale
+		cur_node.closed = true;
+		--budget;
+
+		if (in_goal(cur.r.first)) {
+			std::vector<region> ret;
+			region at = cur.r;
+			while (at != start) {
+				ret.push_back(at);
+				at = nodes[at].parent;
+			}
+			ret.push_back(start);
+			std::reverse(ret.begin(), ret.end());
+			return ret;
+		}
+
+		const connectivity& here = lookup(cur.r.first);
+		const int new_g = cur_node.gscore + SEE;
+		const auto relax = [&](const region& next) {
+			auto it = nodes.find(next);
+			if (nodes.end() == it) it = nodes.emplace(next, node{ new_g, false, cur.r }).first;
+			else if (it->second.closed || new_g >= it->second.gscore) return;
+			else {
+				it->second.gscore = new_g;
+				it->second.parent = cur.r;
+			}
+			open.push_back(open_entry{ new_g + heuristic(next.first), seq++, next });
+			std::push_heap(open.begin(), open.end());
+		};
+
+		for (decltype(auto) dir : Direction::vector) {
+			const tripoint next_sm = cur.r.first + dir;
+			const connectivity& there = lookup(next_sm);
+			if (!there.regions) continue;
+			if (dir.x && dir.y) {	// diagonal neighbor: only the corner tiles touch
+				const point ours(0 < dir.x ? SEE - 1 : 0, 0 < dir.y ? SEE - 1 : 0);
+				const point theirs(SEE - 1 - ours.x, SEE - 1 - ours.y);
+				if (cur.r.second == here.label[ours.x][ours.y] && there.label[theirs.x][theirs.y]) {
+					relax(region(next_sm, there.label[theirs.x][theirs.y]));
+				}
+				continue;
+			}
+			// orthogonal neighbor: each boundary tile of ours touches up to three of theirs
+			const point along(dir.y ? 1 : 0, dir.x ? 1 : 0);
+			const point ours_origin(0 < dir.x ? SEE - 1 : 0, 0 < dir.y ? SEE - 1 : 0);
+			const point theirs_origin(0 > dir.x ? SEE - 1 : 0, 0 > dir.y ? SEE - 1 : 0);
+			for (int i = 0; i < SEE; i++) {
+				const point ours = ours_origin + i * along;
+				if (cur.r.second != here.label[ours.x][ours.y]) continue;
+				for (int j = std::max(0, i - 1); j <= std::min(SEE - 1, i + 1); j++) {
+					const point theirs = theirs_origin + j * along;
+					if (const unsigned char their_label = there.label[theirs.x][theirs.y]) relax(region(next_sm, their_label));
+				}
+			}
+		}
+	}
+	return std::nullopt;
+}
+
+std::optional<GPS_loc> submap_graph::nearest(const region& r, const GPS_loc& origin)
+{
+	const connectivity& src = lookup(r.first);
+	std::optional<GPS_loc> ret;
+	int best = INT_MAX;
+	point pt;
+	for (pt.x = 0; pt.x < SEE; pt.x++) {
+		for (pt.y = 0; pt.y < SEE; pt.y++) {
+			if (r.second != src.label[pt.x][pt.y]) continue;
+			const GPS_loc loc(r.first, pt);
+			const int dist = rl_dist(origin, loc);
+			if (dist < best) {
+				best = dist;
+				ret = loc;
+			}
+		}
+	}
+	return ret;
+}
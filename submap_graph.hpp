@@ -0,0 +1,64 @@
+#ifndef SUBMAP_GRAPH_HPP
+#define SUBMAP_GRAPH_HPP 1
+
+#include "GPS_loc.hpp"
+#include "ui.h"
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+struct submap;
+
+// Coarse (submap-level) pathfinding for routes that leave the reality bubble.
+// Each submap is summarized as the 8-connected regions of its passable tiles; regions of adjacent submaps
+// are linked wherever their boundary tiles touch.  Searching this graph costs roughly O(path length in submaps);
+// the tile-level A* (map::route) then refines the next few submaps of the plan.
+// singleton
+class submap_graph
+{
+public:
+	using region = std::pair<tripoint, unsigned char>;	// submap GPS coordinate, 1-based region label
+
+	static constexpr const size_t default_budget = 4096;	// maximum regions expanded by one route() call
+	static constexpr const size_t cache_budget = 8 * default_budget;	// submaps summarized before the least recently used are dropped
+
+private:
+	struct connectivity {
+		unsigned long long revision;	// submap::tile_revision() this was computed from
+		int last_used;	// turn
+		bool synthetic;	// submap not generated yet; inferred from overmap terrain
+		unsigned char regions;
+		unsigned char label[SEE][SEE];	// 0: impassable
+	};
+
+	std::map<tripoint, connectivity> _cache;
+
+	submap_graph() = default;
+	~submap_graph() = default;
+	submap_graph(const submap_graph& src) = delete;
+	submap_graph(submap_graph&& src) = delete;
+	submap_graph& operator=(const submap_graph& src) = delete;
+	submap_graph& operator=(submap_graph&& src) = delete;
+
+	const connectivity& lookup(const tripoint& sm);
+	void evict();
+	static void build(connectivity& dest, const submap& sm);
+	static void build(connectivity& dest, const tripoint& sm);
+
+public:
+	static submap_graph& get();
+
+	static bool is_passable(ter_id t);	// as the tile-level route would consider it, ignoring vehicles
+	unsigned char label(const GPS_loc& loc);	// 0 if impassable
+
+	// sequence of regions from src's region to a region inside dest (inclusive); std::nullopt if no route within budget
+	std::optional<std::vector<region> > route(const GPS_loc& src, const OM_loc<2>& dest, size_t budget = default_budget);
+	// tile of region r closest to origin
+	std::optional<GPS_loc> nearest(const region& r, const GPS_loc& origin);
+
+	void clear() { _cache.clear(); }
+	auto size() const { return _cache.size(); }
+};
+
+#endif
@@ -5,7 +5,7 @@
 #include <string.h>
 #include "Zaimoni.STL/Logging.h"
 
-static const char* const JSON_transcode_traps[] = {
+static constexpr const char* JSON_transcode_traps[] = {
 	"bubblewrap",
 	"beartrap",
 	"beartrap_buried",
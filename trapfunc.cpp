@@ -476,7 +476,7 @@ void trapfunc::temple_toggle(game *g, int x, int y)
  ter_id type = g->m.ter(x, y);
  for (int i = 0; i < SEEX * MAPSIZE; i++) {
   for (int j = 0; j < SEEY * MAPSIZE; j++) {
-   auto& t = g->m.ter(i, j);
+   auto t = g->m.ter(i, j);
    switch (type) {
     case t_floor_red:
      if (t_rock_green == t) t = t_floor_green;
@@ -8,7 +8,7 @@
 #include "recent_msg.h"
 #include <string>
 
-static bool inv_has_welder(const inventory& src)
+static bool inv_has_welder(const crafting_stock& src)
 {
     const int charges = dynamic_cast<it_tool*>(item::types[itm_welder])->charges_per_use;
     return (src.has_amount(itm_welder, 1) && src.has_charges(itm_welder, charges))
@@ -18,7 +18,7 @@ static bool inv_has_welder(const inventory& src)
 // no UI manipulation in the constructor; leave that in ...::exec
 veh_interact::veh_interact(int cx, int cy, vehicle *v, player& u)
 : c(cx, cy), dd(0, 0), sel_cmd(' '), cpart(-1), veh(v), u(u),
-  crafting_inv(crafting_inventory(u)),
+  crafting_inv(u),
   has_wrench(crafting_inv.has_amount(itm_wrench, 1) || crafting_inv.has_amount(itm_toolset, 1)),
   has_hacksaw(crafting_inv.has_amount(itm_hacksaw, 1) || crafting_inv.has_amount(itm_toolset, 1)),
   has_welder(inv_has_welder(crafting_inv))
@@ -1,6 +1,7 @@
 #ifndef _VEH_INTERACT_H_
 #define _VEH_INTERACT_H_
 
+#include "crafting.h"
 #include "inventory.h"
 
 class vehicle;
@@ -35,7 +36,7 @@ private:
 
     vehicle* const veh;
     player& u;
-    const inventory crafting_inv;
+    const crafting_stock crafting_inv;
     const bool has_wrench;
     const bool has_hacksaw;
     const bool has_welder;
@@ -4,7 +4,6 @@
 #include "recent_msg.h"
 #include "rng.h"
 #include "saveload.h"
-#include "mapbuffer.h"
 
 #include <stdlib.h>
 #include <math.h>
@@ -14,7 +13,7 @@
 void trap_fully_triggered(map& m, const point& pt, const std::vector<item_drop_spec>& drop_these); // trapfunc.cpp
 void trap_fully_triggered(GPS_loc loc, const std::vector<item_drop_spec>& drop_these); // trapfunc.cpp
 
-static const char* const JSON_transcode_vparts[] = {
+static constexpr const char* JSON_transcode_vparts[] = {
 	"seat",
 	"frame_h",
 	"frame_v",
@@ -67,7 +66,7 @@ static const char* const JSON_transcode_vparts[] = {
 	"hard_plate"
 };
 
-static const char* const JSON_transcode_vtypes[] = {
+static constexpr const char* JSON_transcode_vtypes[] = {
 	"custom",
 	"motorcycle",
 	"sandbike",
@@ -103,7 +102,7 @@ DEFINE_ACID_ASSIGN_W_MOVE(vehicle)
 
 void vehicle::destroy(vehicle& veh)
 {
-    if (const auto sm = MAPBUFFER.lookup_submap(veh.GPSpos.first)) sm->destroy(veh);
+    game::active()->m.remove_vehicle(veh);
 }
 
 std::string vehicle::possessive() const
@@ -431,6 +430,9 @@ void vehicle::precalc_mounts (int idir, int dir)
 {
     if (idir < 0 || idir > 1) idir = 0;
 	for(auto& part : parts) part.precalc_d[idir] = coord_translate(dir, part.mount_d);
+	if (0 == idir) {
+		if (const auto g = game::active()) g->m.vehicles_moved(GPSpos);
+	}
 }
 
 bool vehicle::any_boarded_parts() const
@@ -3,7 +3,7 @@
 #include "rng.h"
 #include "recent_msg.h"
 
-static const char* const JSON_transcode[] = {
+static constexpr const char* JSON_transcode[] = {
 	"CLEAR",
 	"SUNNY",
 	"CLOUDY",